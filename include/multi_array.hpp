@@ -28,6 +28,7 @@
 #include <cstdint> // int
 #include <cstring> // std::memcpy, std::memcmp
 
+#include <array>
 #include <span>
 #include <tuple>
 #include <type_traits>
@@ -98,6 +99,12 @@ using is_valid_multi_array_type =
     std::enable_if_t<std::conjunction<std::is_default_constructible<T>, std::is_trivially_copyable<T>>::value, T>;
 }
 
+// Tag, construct without initializing the elements.
+struct uninitialized_t {
+    explicit uninitialized_t ( ) = default;
+};
+inline constexpr uninitialized_t uninitialized{ };
+
 template<typename T, int I, int BaseI = 0, typename = detail::is_valid_multi_array_type<T>>
 class Vector {
 
@@ -112,10 +119,12 @@ class Vector {
     [[nodiscard]] static constexpr std::size_t size ( ) noexcept { return I; }
     [[nodiscard]] static constexpr std::size_t capacity ( ) noexcept { return I; }
     [[nodiscard]] static constexpr extents_type extents ( ) noexcept { return { I }; }
+    [[nodiscard]] static constexpr extents_type bases ( ) noexcept { return { BaseI }; }
 
     MA_COMMON_ELEMENTS
 
     Vector ( ) noexcept : m_data{ T{} } {}
+    explicit Vector ( uninitialized_t ) noexcept {}
     Vector ( Vector const & v_ ) noexcept { std::memcpy ( m_data, v_.m_data, size ( ) * sizeof ( T ) ); }
     Vector ( Vector && v_ ) noexcept = delete;
     template<typename... Args>
@@ -185,7 +194,7 @@ class VectorView : public std::span<T> {
     using std::span<T>::data;
 
     public:
-    VectorView ( T * p_, int const i_ ) noexcept : std::span<T>{ p_, static_cast<typename std::span<T>::index_type> ( i_ ) } {}
+    VectorView ( T * p_, int const i_ ) noexcept : std::span<T>{ p_, static_cast<typename std::span<T>::size_type> ( i_ ) } {}
 
     [[nodiscard]] static constexpr int rebase ( ) noexcept { return -BaseI; }
     [[nodiscard]] static constexpr int reverse_rebase ( ) noexcept { return I - 1 + BaseI; }
@@ -196,6 +205,7 @@ class VectorView : public std::span<T> {
     [[nodiscard]] static constexpr std::size_t size ( ) noexcept { return I; }
     [[nodiscard]] static constexpr std::size_t capacity ( ) noexcept { return I; }
     [[nodiscard]] static constexpr extents_type extents ( ) noexcept { return { I }; }
+    [[nodiscard]] static constexpr extents_type bases ( ) noexcept { return { BaseI }; }
 
     MA_COMMON_TYPEDEFS
 
@@ -266,10 +276,12 @@ class Matrix {
     [[nodiscard]] static constexpr std::size_t size ( ) noexcept { return I * J; }
     [[nodiscard]] static constexpr std::size_t capacity ( ) noexcept { return I * J; }
     [[nodiscard]] static constexpr extents_type extents ( ) noexcept { return { I, J }; }
+    [[nodiscard]] static constexpr extents_type bases ( ) noexcept { return { BaseI, BaseJ }; }
 
     MA_COMMON_ELEMENTS
 
     Matrix ( ) noexcept : m_data{ T{} } {}
+    explicit Matrix ( uninitialized_t ) noexcept {}
     Matrix ( Matrix const & m_ ) noexcept { std::memcpy ( m_data, m_.m_data, size ( ) * sizeof ( T ) ); }
     Matrix ( Matrix && m_ ) noexcept = delete;
     template<typename... Args>
@@ -358,10 +370,12 @@ class Cube {
     [[nodiscard]] static constexpr std::size_t size ( ) noexcept { return I * J * K; }
     [[nodiscard]] static constexpr std::size_t capacity ( ) noexcept { return I * J * K; }
     [[nodiscard]] static constexpr extents_type extents ( ) noexcept { return { I, J, K }; }
+    [[nodiscard]] static constexpr extents_type bases ( ) noexcept { return { BaseI, BaseJ, BaseK }; }
 
     MA_COMMON_ELEMENTS
 
     Cube ( ) noexcept : m_data{ T{} } {}
+    explicit Cube ( uninitialized_t ) noexcept {}
     Cube ( Cube const & c_ ) noexcept { std::memcpy ( m_data, c_.m_data, size ( ) * sizeof ( T ) ); }
     Cube ( Cube && c_ ) noexcept = delete;
     template<typename... Args>
@@ -446,10 +460,12 @@ class HyperCube {
     [[nodiscard]] static constexpr std::size_t size ( ) noexcept { return I * J * K * L; }
     [[nodiscard]] static constexpr std::size_t capacity ( ) noexcept { return I * J * K * L; }
     [[nodiscard]] static constexpr extents_type extents ( ) noexcept { return { I, J, K, L }; }
+    [[nodiscard]] static constexpr extents_type bases ( ) noexcept { return { BaseI, BaseJ, BaseK, BaseL }; }
 
     MA_COMMON_ELEMENTS
 
     HyperCube ( ) noexcept : m_data{ T{} } {}
+    explicit HyperCube ( uninitialized_t ) noexcept {}
     HyperCube ( HyperCube const & h_ ) noexcept { std::memcpy ( m_data, h_.m_data, size ( ) * sizeof ( T ) ); }
     HyperCube ( HyperCube && h_ ) noexcept = delete;
     template<typename... Args>
@@ -489,6 +505,71 @@ class HyperCube {
     }
 };
 
+namespace detail {
+
+// The (row-major) layout of any of the above, i.e. the bits needed to go from base-adjusted coordinates to an
+// offset into data ( ) and back again.
+template<typename Array>
+struct layout {
+
+    static constexpr int rank = static_cast<int> ( std::tuple_size_v<typename Array::extents_type> );
+
+    using coordinates_type = std::array<int, rank>;
+
+    static constexpr coordinates_type extents =
+        std::apply ( [] ( auto... e_ ) noexcept { return coordinates_type{ e_... }; }, Array::extents ( ) );
+    static constexpr coordinates_type bases =
+        std::apply ( [] ( auto... b_ ) noexcept { return coordinates_type{ b_... }; }, Array::bases ( ) );
+    static constexpr coordinates_type strides = [] ( ) noexcept {
+        coordinates_type s{ };
+        int a = 1;
+        for ( int r = rank - 1; r >= 0; --r ) {
+            s[ r ] = a;
+            a *= extents[ r ];
+        }
+        return s;
+    }( );
+    static constexpr int rebase = [] ( ) noexcept {
+        int o = 0;
+        for ( int r = 0; r < rank; ++r )
+            o -= bases[ r ] * strides[ r ];
+        return o;
+    }( );
+
+    [[nodiscard]] static constexpr int offset ( coordinates_type const & c_ ) noexcept {
+        int o = rebase;
+        for ( int r = 0; r < rank; ++r ) {
+            assert ( c_[ r ] >= bases[ r ] );
+            assert ( c_[ r ] < extents[ r ] + bases[ r ] );
+            o += c_[ r ] * strides[ r ];
+        }
+        return o;
+    }
+
+    [[nodiscard]] static constexpr coordinates_type coordinates ( int o_ ) noexcept {
+        coordinates_type c;
+        for ( int r = 0; r < rank; ++r ) {
+            c[ r ] = o_ / strides[ r ] + bases[ r ];
+            o_ %= strides[ r ];
+        }
+        return c;
+    }
+};
+
+// The elements of any of the above, or of a [VectorView or] std::span, as a flat std::span.
+template<typename X>
+[[nodiscard]] constexpr auto elements ( X & x_ ) noexcept {
+    if constexpr ( requires { typename X::element_type; } )
+        return static_cast<std::span<typename X::element_type> const &> ( x_ );
+    else
+        return std::span{ x_.data ( ), x_.size ( ) };
+}
+} // namespace detail
+
+// Base-adjusted coordinates of an element of Array.
+template<typename Array>
+using coordinates_t = typename detail::layout<Array>::coordinates_type;
+
 } // namespace sax
 
 #undef MA_ASSERT_4
@@ -0,0 +1,212 @@
+
+// MIT License
+//
+// Copyright (c) 2019, 2020 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef> // std::size_t
+#include <cstdint> // std::uintptr_t
+#include <cstdlib> // std::aligned_alloc, std::free
+#include <cstring> // std::memset
+
+#include <memory>
+#include <new> // std::bad_alloc
+
+#if defined( __linux__ )
+#    include <fstream>
+#    include <string>
+#    include <linux/mempolicy.h> // MPOL_BIND, MPOL_INTERLEAVE
+#    include <sys/mman.h>
+#    include <sys/syscall.h>
+#    include <unistd.h>
+#elif defined( _WIN32 )
+#    include <windows.h>
+#endif
+
+#include "multi_array.hpp"
+#include "multi_array_parallel.hpp"
+
+// Heap allocation of large arrays, make_large<Array> ( policy ) allocates [and constructs] an Array directly from the
+//  OS (mmap, VirtualAlloc), 2MB aligned, optionally backed by (transparent or explicit) huge pages and placed on
+//  specific NUMA nodes. Memory from the OS is zero-filled on first touch, so the default construction [T{}, one thread
+//  writing all of it] is skipped. The pages are instead touched either (zero) by the calling thread, (first_touch) in
+//  parallel, in the partitions of parallel_for ( size ( ) ) [so a parallel traversal finds its pages on its own node],
+//  or (none) not at all, left to whoever touches them first.
+//
+//  The huge page and NUMA requests are best effort, if the OS refuses, the allocation falls back to normal pages and
+//  the default placement.
+
+namespace sax {
+
+enum class page_policy { normal, transparent_huge, explicit_huge };
+enum class init_policy { zero, none, first_touch };
+enum class numa_policy { local, interleave, bind };
+
+struct allocation_policy {
+    page_policy pages   = page_policy::transparent_huge;
+    init_policy init    = init_policy::first_touch;
+    numa_policy numa    = numa_policy::local;
+    unsigned long nodes = 0; // Node mask for interleave [0 is all online nodes] and bind [0 is node 0].
+    unsigned threads    = 0; // The threads doing the first_touch, as in parallel_for ( ).
+};
+
+namespace detail {
+
+inline constexpr std::size_t huge_page_size = std::size_t{ 1 } << 21;
+
+[[nodiscard]] constexpr std::size_t round_up ( std::size_t const n_, std::size_t const a_ ) noexcept {
+    return ( n_ + a_ - 1 ) / a_ * a_;
+}
+
+#if defined( __linux__ )
+
+// The mask of the online NUMA nodes, f.e. "0-1" or "0,2-3".
+[[nodiscard]] inline unsigned long online_nodes ( ) {
+    std::ifstream f{ "/sys/devices/system/node/online" };
+    std::string s;
+    if ( not std::getline ( f, s ) )
+        return 1ul;
+    unsigned long m = 0;
+    for ( std::size_t i = 0; i < s.size ( ); ) {
+        std::size_t e          = 0;
+        unsigned long const lo = std::stoul ( s.substr ( i ), &e );
+        unsigned long hi       = lo;
+        i += e;
+        if ( i < s.size ( ) and '-' == s[ i ] ) {
+            hi = std::stoul ( s.substr ( ++i ), &e );
+            i += e;
+        }
+        for ( unsigned long n = lo; n <= hi and n < 8 * sizeof ( m ); ++n )
+            m |= 1ul << n;
+        if ( i < s.size ( ) and ',' == s[ i ] )
+            ++i;
+        else
+            break;
+    }
+    return m ? m : 1ul;
+}
+
+[[nodiscard]] inline void * allocate_large ( std::size_t const bytes_, allocation_policy const & p_ ) {
+    void * p = MAP_FAILED;
+    if ( page_policy::explicit_huge == p_.pages )
+        p = mmap ( nullptr, bytes_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0 );
+    if ( MAP_FAILED == p ) {
+        // Over-allocate and trim, for a 2MB aligned range, which transparent huge pages need.
+        std::size_t const o = bytes_ + huge_page_size;
+        void * const m      = mmap ( nullptr, o, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+        if ( MAP_FAILED == m )
+            throw std::bad_alloc{ };
+        char * const q = static_cast<char *> ( m );
+        std::uintptr_t const u = reinterpret_cast<std::uintptr_t> ( q );
+        char * const a         = q + ( round_up ( u, huge_page_size ) - u );
+        if ( a != q )
+            munmap ( q, static_cast<std::size_t> ( a - q ) );
+        if ( q + o != a + bytes_ )
+            munmap ( a + bytes_, static_cast<std::size_t> ( ( q + o ) - ( a + bytes_ ) ) );
+        p = a;
+        if ( page_policy::normal != p_.pages )
+            madvise ( p, bytes_, MADV_HUGEPAGE );
+    }
+    if ( numa_policy::local != p_.numa ) {
+        // Before anything touches the pages.
+        unsigned long const mask = numa_policy::interleave == p_.numa ? ( p_.nodes ? p_.nodes : online_nodes ( ) )
+                                                                      : ( p_.nodes ? p_.nodes : 1ul );
+        syscall ( SYS_mbind, p, bytes_, numa_policy::interleave == p_.numa ? MPOL_INTERLEAVE : MPOL_BIND, &mask,
+                  8 * sizeof ( mask ) + 1, 0u );
+    }
+    return p;
+}
+
+inline void deallocate_large ( void * const p_, std::size_t const bytes_ ) noexcept { munmap ( p_, bytes_ ); }
+
+#elif defined( _WIN32 )
+
+[[nodiscard]] inline void * allocate_large ( std::size_t const bytes_, allocation_policy const & p_ ) {
+    // Interleaving is not available, the pages are placed by first touch.
+    DWORD node = 0;
+    while ( p_.nodes and not( p_.nodes >> node & 1ul ) )
+        ++node;
+    void * p = nullptr;
+    if ( page_policy::explicit_huge == p_.pages and GetLargePageMinimum ( ) ) // Requires SeLockMemoryPrivilege.
+        p = numa_policy::bind == p_.numa
+                ? VirtualAllocExNuma ( GetCurrentProcess ( ), nullptr, bytes_, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES,
+                                       PAGE_READWRITE, node )
+                : VirtualAlloc ( nullptr, bytes_, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE );
+    if ( not p )
+        p = numa_policy::bind == p_.numa
+                ? VirtualAllocExNuma ( GetCurrentProcess ( ), nullptr, bytes_, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE, node )
+                : VirtualAlloc ( nullptr, bytes_, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE );
+    if ( not p )
+        throw std::bad_alloc{ };
+    return p;
+}
+
+inline void deallocate_large ( void * const p_, std::size_t ) noexcept { VirtualFree ( p_, 0, MEM_RELEASE ); }
+
+#else
+
+[[nodiscard]] inline void * allocate_large ( std::size_t const bytes_, allocation_policy const & ) {
+    void * const p = std::aligned_alloc ( huge_page_size, bytes_ );
+    if ( not p )
+        throw std::bad_alloc{ };
+    std::memset ( p, 0, bytes_ ); // Not guaranteed to be zeroed.
+    return p;
+}
+
+inline void deallocate_large ( void * const p_, std::size_t ) noexcept { std::free ( p_ ); }
+
+#endif
+
+template<typename Array>
+struct large_deleter {
+    void operator( ) ( Array * const a_ ) const noexcept {
+        a_->~Array ( );
+        deallocate_large ( a_, round_up ( sizeof ( Array ), huge_page_size ) );
+    }
+};
+} // namespace detail
+
+template<typename Array>
+using large_ptr = std::unique_ptr<Array, detail::large_deleter<Array>>;
+
+// A heap allocated Array, with (all bits) zero elements.
+template<typename Array>
+[[nodiscard]] large_ptr<Array> make_large ( allocation_policy const & p_ = { } ) {
+    std::size_t const b = detail::round_up ( sizeof ( Array ), detail::huge_page_size );
+    Array * const a     = ::new ( detail::allocate_large ( b, p_ ) ) Array ( uninitialized );
+    using value_type    = typename Array::value_type;
+    switch ( p_.init ) {
+        case init_policy::zero: std::memset ( a->data ( ), 0, sizeof ( Array ) ); break;
+        case init_policy::first_touch:
+            parallel_for (
+                Array::size ( ),
+                [ d = a->data ( ) ] ( unsigned, std::size_t const b_, std::size_t const e_ ) noexcept {
+                    std::memset ( d + b_, 0, ( e_ - b_ ) * sizeof ( value_type ) );
+                },
+                p_.threads );
+            break;
+        case init_policy::none: break;
+    }
+    return large_ptr<Array>{ a };
+}
+
+} // namespace sax
@@ -0,0 +1,428 @@
+
+// MIT License
+//
+// Copyright (c) 2019, 2020 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cassert> // assert
+#include <cstddef> // std::size_t
+#include <cstdint> // std::uint8_t, std::uint16_t, std::uint32_t, std::uint64_t
+#include <cstring> // std::memcpy
+
+#include <type_traits>
+#include <vector>
+
+#include "multi_array.hpp"
+
+// In-memory compression of cold arrays. Compressed<Array> holds the elements of an Array [any of Vector, Matrix, Cube
+//  or HyperCube] as independently compressed tiles of TileSize consecutive elements. Tiles are decompressed on access
+//  into a small LRU cache of CacheSize tiles, dirty tiles are recompressed on eviction (or flush ( )).
+//
+//  The codec is delta (integers) or xor (everything else) against the previous element, followed by a byte-shuffle
+//  (byte b of all elements together) and a LZ4-style byte-oriented LZ77 compressor.
+//
+//  at ( ) is a write [the tile will be recompressed], read with get ( ) [or through a const Compressed].
+//
+//  Note: a reference obtained from at ( ) is only valid until the next access that (re-)loads a tile. Not thread-safe,
+//  not even for const access, as the cache is shared.
+
+namespace sax {
+
+namespace detail {
+
+namespace lz {
+
+inline constexpr int hash_log      = 12;
+inline constexpr int min_match     = 4;
+inline constexpr int max_offset    = 65'535;
+inline constexpr int last_literals = 5;  // A match never extends into the last 5 bytes.
+inline constexpr int match_limit   = 12; // No match starts in the last 12 bytes.
+
+[[nodiscard]] inline std::uint32_t read32 ( std::uint8_t const * p_ ) noexcept {
+    std::uint32_t v;
+    std::memcpy ( &v, p_, sizeof ( v ) );
+    return v;
+}
+
+inline void put_length ( std::vector<std::uint8_t> & d_, std::size_t l_ ) {
+    for ( ; l_ >= 255; l_ -= 255 )
+        d_.push_back ( 255 );
+    d_.push_back ( static_cast<std::uint8_t> ( l_ ) );
+}
+
+inline void put_sequence ( std::vector<std::uint8_t> & d_, std::uint8_t const * literals_, std::size_t const literal_length_,
+                           std::size_t const offset_, std::size_t const match_length_ ) {
+    std::size_t const m = match_length_ ? match_length_ - min_match : 0;
+    d_.push_back ( static_cast<std::uint8_t> ( ( ( literal_length_ < 15 ? literal_length_ : 15 ) << 4 ) | ( m < 15 ? m : 15 ) ) );
+    if ( literal_length_ >= 15 )
+        put_length ( d_, literal_length_ - 15 );
+    d_.insert ( d_.end ( ), literals_, literals_ + literal_length_ );
+    if ( match_length_ ) {
+        d_.push_back ( static_cast<std::uint8_t> ( offset_ ) );
+        d_.push_back ( static_cast<std::uint8_t> ( offset_ >> 8 ) );
+        if ( m >= 15 )
+            put_length ( d_, m - 15 );
+    }
+}
+
+// Appends the compressed s_[ 0 .. n_ ) to d_.
+inline void compress ( std::uint8_t const * s_, std::size_t const n_, std::vector<std::uint8_t> & d_ ) {
+    std::size_t anchor = 0;
+    if ( n_ > match_limit ) {
+        int table[ 1 << hash_log ];
+        for ( int & t : table )
+            t = -1;
+        std::size_t const limit = n_ - match_limit;
+        std::size_t ip = 0, misses = 0;
+        while ( ip < limit ) {
+            std::uint32_t const seq = read32 ( s_ + ip );
+            std::uint32_t const h   = ( seq * 2'654'435'761u ) >> ( 32 - hash_log );
+            int const ref           = table[ h ];
+            table[ h ]              = static_cast<int> ( ip );
+            if ( ref >= 0 and ip - static_cast<std::size_t> ( ref ) <= max_offset and read32 ( s_ + ref ) == seq ) {
+                std::size_t l = min_match;
+                while ( ip + l < n_ - last_literals and s_[ ref + l ] == s_[ ip + l ] )
+                    ++l;
+                put_sequence ( d_, s_ + anchor, ip - anchor, ip - ref, l );
+                ip += l;
+                anchor = ip;
+                misses = 0;
+            }
+            else {
+                ip += 1 + ( misses++ >> 6 ); // Skip faster through incompressible data.
+            }
+        }
+    }
+    put_sequence ( d_, s_ + anchor, n_ - anchor, 0, 0 );
+}
+
+// Decompresses s_[ 0 .. n_ ) into d_, returns the number of bytes written.
+inline std::size_t decompress ( std::uint8_t const * s_, std::size_t const n_, std::uint8_t * d_ ) noexcept {
+    std::size_t ip = 0, op = 0;
+    for ( ;; ) {
+        std::uint8_t const token = s_[ ip++ ];
+        std::size_t l            = token >> 4;
+        if ( 15 == l ) {
+            std::uint8_t b;
+            do {
+                b = s_[ ip++ ];
+                l += b;
+            } while ( 255 == b );
+        }
+        std::memcpy ( d_ + op, s_ + ip, l );
+        ip += l;
+        op += l;
+        if ( ip >= n_ )
+            break;
+        std::size_t const offset = s_[ ip ] | ( static_cast<std::size_t> ( s_[ ip + 1 ] ) << 8 );
+        ip += 2;
+        std::size_t m = token & 15;
+        if ( 15 == m ) {
+            std::uint8_t b;
+            do {
+                b = s_[ ip++ ];
+                m += b;
+            } while ( 255 == b );
+        }
+        m += min_match;
+        assert ( offset and offset <= op );
+        std::uint8_t const * r = d_ + op - offset;
+        if ( offset >= m ) {
+            std::memcpy ( d_ + op, r, m );
+        }
+        else {
+            for ( std::size_t i = 0; i < m; ++i ) // Overlapping, i.e. a repeating pattern.
+                d_[ op + i ] = r[ i ];
+        }
+        op += m;
+    }
+    return op;
+}
+} // namespace lz
+
+template<std::size_t Size>
+using word_t = std::conditional_t<
+    1 == Size, std::uint8_t,
+    std::conditional_t<2 == Size, std::uint16_t,
+                       std::conditional_t<4 == Size, std::uint32_t, std::conditional_t<8 == Size, std::uint64_t, void>>>>;
+
+// Delta (integers) or xor (floating point, others) against the previous element, then byte-shuffle.
+template<typename T>
+void shuffle ( T const * s_, std::size_t const n_, std::uint8_t * d_ ) noexcept {
+    using word = word_t<sizeof ( T )>;
+    std::uint8_t const * const b = reinterpret_cast<std::uint8_t const *> ( s_ );
+    if constexpr ( std::is_void_v<word> ) {
+        for ( std::size_t i = 0; i < n_; ++i )
+            for ( std::size_t p = 0; p < sizeof ( T ); ++p )
+                d_[ p * n_ + i ] = b[ i * sizeof ( T ) + p ];
+    }
+    else {
+        word prev = 0;
+        for ( std::size_t i = 0; i < n_; ++i ) {
+            word w;
+            std::memcpy ( &w, b + i * sizeof ( T ), sizeof ( T ) );
+            word const v = std::is_integral_v<T> ? static_cast<word> ( w - prev ) : static_cast<word> ( w ^ prev );
+            prev         = w;
+            for ( std::size_t p = 0; p < sizeof ( T ); ++p )
+                d_[ p * n_ + i ] = static_cast<std::uint8_t> ( v >> ( 8 * p ) );
+        }
+    }
+}
+
+template<typename T>
+void unshuffle ( std::uint8_t const * s_, std::size_t const n_, T * d_ ) noexcept {
+    using word = word_t<sizeof ( T )>;
+    std::uint8_t * const b = reinterpret_cast<std::uint8_t *> ( d_ );
+    if constexpr ( std::is_void_v<word> ) {
+        for ( std::size_t i = 0; i < n_; ++i )
+            for ( std::size_t p = 0; p < sizeof ( T ); ++p )
+                b[ i * sizeof ( T ) + p ] = s_[ p * n_ + i ];
+    }
+    else {
+        word prev = 0;
+        for ( std::size_t i = 0; i < n_; ++i ) {
+            word v = 0;
+            for ( std::size_t p = 0; p < sizeof ( T ); ++p )
+                v |= static_cast<word> ( static_cast<word> ( s_[ p * n_ + i ] ) << ( 8 * p ) );
+            word const w = std::is_integral_v<T> ? static_cast<word> ( v + prev ) : static_cast<word> ( v ^ prev );
+            prev         = w;
+            std::memcpy ( b + i * sizeof ( T ), &w, sizeof ( T ) );
+        }
+    }
+}
+} // namespace detail
+
+template<typename Array, int TileSize = 4'096, int CacheSize = 8>
+class Compressed {
+
+    static_assert ( TileSize > 0 and CacheSize > 0 );
+
+    using layout = detail::layout<Array>;
+
+    public:
+    using value_type       = typename Array::value_type;
+    using reference        = value_type &;
+    using const_reference  = value_type const &;
+    using size_type        = std::size_t;
+    using extents_type     = typename Array::extents_type;
+    using coordinates_type = coordinates_t<Array>;
+
+    [[nodiscard]] static constexpr std::size_t size ( ) noexcept { return Array::size ( ); }
+    [[nodiscard]] static constexpr extents_type extents ( ) noexcept { return Array::extents ( ); }
+    [[nodiscard]] static constexpr extents_type bases ( ) noexcept { return Array::bases ( ); }
+    [[nodiscard]] static constexpr std::size_t tiles ( ) noexcept { return ( size ( ) + TileSize - 1 ) / TileSize; }
+
+    private:
+    enum : std::uint8_t { stored = 0, packed = 1 };
+
+    struct line {
+        int tile            = -1;
+        bool dirty          = false;
+        std::uint64_t stamp = 0;
+        value_type data[ TileSize ];
+    };
+
+    mutable std::vector<std::vector<std::uint8_t>> m_tiles;
+    mutable std::vector<line> m_cache;
+    mutable line * m_last         = nullptr;
+    mutable std::uint64_t m_clock = 0;
+    mutable std::vector<std::uint8_t> m_scratch;
+
+    [[nodiscard]] static constexpr std::size_t tile_size ( int const t_ ) noexcept {
+        return static_cast<std::size_t> ( t_ ) + 1 < tiles ( ) ? TileSize : size ( ) - static_cast<std::size_t> ( t_ ) * TileSize;
+    }
+
+    void pack ( int const t_, value_type const * s_ ) const {
+        std::size_t const n = tile_size ( t_ ), b = n * sizeof ( value_type );
+        m_scratch.resize ( b );
+        detail::shuffle ( s_, n, m_scratch.data ( ) );
+        std::vector<std::uint8_t> & d = m_tiles[ t_ ];
+        d.clear ( );
+        d.push_back ( packed );
+        detail::lz::compress ( m_scratch.data ( ), b, d );
+        if ( d.size ( ) > b ) { // Incompressible, store.
+            d.resize ( 1 + b );
+            d[ 0 ] = stored;
+            std::memcpy ( d.data ( ) + 1, m_scratch.data ( ), b );
+        }
+        d.shrink_to_fit ( );
+    }
+
+    void unpack ( int const t_, value_type * d_ ) const {
+        std::size_t const n = tile_size ( t_ ), b = n * sizeof ( value_type );
+        std::vector<std::uint8_t> const & s = m_tiles[ t_ ];
+        m_scratch.resize ( b );
+        if ( stored == s[ 0 ] ) {
+            std::memcpy ( m_scratch.data ( ), s.data ( ) + 1, b );
+        }
+        else {
+            [[maybe_unused]] std::size_t const w = detail::lz::decompress ( s.data ( ) + 1, s.size ( ) - 1, m_scratch.data ( ) );
+            assert ( w == b );
+        }
+        detail::unshuffle ( m_scratch.data ( ), n, d_ );
+    }
+
+    void evict ( line & l_ ) const {
+        if ( l_.dirty )
+            pack ( l_.tile, l_.data );
+        l_.tile  = -1;
+        l_.dirty = false;
+    }
+
+    [[nodiscard]] line & fetch ( int const t_ ) const {
+        if ( m_last and m_last->tile == t_ ) {
+            m_last->stamp = ++m_clock;
+            return *m_last;
+        }
+        line * lru = m_cache.data ( );
+        for ( line & l : m_cache ) {
+            if ( l.tile == t_ ) {
+                l.stamp = ++m_clock;
+                return *( m_last = &l );
+            }
+            if ( l.stamp < lru->stamp )
+                lru = &l;
+        }
+        evict ( *lru );
+        unpack ( t_, lru->data );
+        lru->tile  = t_;
+        lru->stamp = ++m_clock;
+        return *( m_last = lru );
+    }
+
+    [[nodiscard]] static constexpr int offset ( coordinates_type const & c_ ) noexcept { return layout::offset ( c_ ); }
+
+    public:
+    Compressed ( ) : m_tiles ( tiles ( ) ), m_cache ( CacheSize ) {
+        line & l = m_cache.front ( );
+        for ( value_type & v : l.data )
+            v = value_type{ };
+        pack ( 0, l.data );
+        for ( int t = 1; t < static_cast<int> ( tiles ( ) ); ++t ) {
+            if ( TileSize == tile_size ( t ) )
+                m_tiles[ t ] = m_tiles[ 0 ];
+            else
+                pack ( t, l.data );
+        }
+    }
+    explicit Compressed ( Array const & a_ ) : m_tiles ( tiles ( ) ), m_cache ( CacheSize ) { assign ( a_ ); }
+
+    Compressed ( Compressed const & c_ ) : m_tiles ( tiles ( ) ), m_cache ( CacheSize ) {
+        c_.flush ( );
+        m_tiles = c_.m_tiles;
+    }
+    Compressed ( Compressed && c_ ) noexcept = delete;
+
+    ~Compressed ( ) = default;
+
+    Compressed & operator= ( Compressed const & rhs_ ) {
+        if ( this != &rhs_ ) {
+            rhs_.flush ( );
+            invalidate ( );
+            m_tiles = rhs_.m_tiles;
+        }
+        return *this;
+    }
+    Compressed & operator= ( Compressed && rhs_ ) noexcept = delete;
+
+    // Compress all of a_, discards the cache.
+    void assign ( Array const & a_ ) {
+        invalidate ( );
+        for ( int t = 0; t < static_cast<int> ( tiles ( ) ); ++t )
+            pack ( t, a_.data ( ) + static_cast<std::size_t> ( t ) * TileSize );
+    }
+
+    // Decompress all into a_.
+    void decompress ( Array & a_ ) const {
+        for ( int t = 0; t < static_cast<int> ( tiles ( ) ); ++t ) {
+            value_type * const d = a_.data ( ) + static_cast<std::size_t> ( t ) * TileSize;
+            line const * c       = nullptr;
+            for ( line const & l : m_cache )
+                if ( l.tile == t )
+                    c = &l;
+            if ( c )
+                std::memcpy ( d, c->data, tile_size ( t ) * sizeof ( value_type ) );
+            else
+                unpack ( t, d );
+        }
+    }
+
+    // Recompress the dirty tiles in the cache [keeping them cached].
+    void flush ( ) const {
+        for ( line & l : m_cache ) {
+            if ( l.dirty ) {
+                pack ( l.tile, l.data );
+                l.dirty = false;
+            }
+        }
+    }
+
+    // Empty the cache [recompressing dirty tiles].
+    void invalidate ( ) const {
+        for ( line & l : m_cache )
+            evict ( l );
+        m_last = nullptr;
+    }
+
+    // Bytes held by the compressed tiles, excluding the cache.
+    [[nodiscard]] std::size_t compressed_size ( ) const noexcept {
+        std::size_t s = 0;
+        for ( auto const & t : m_tiles )
+            s += t.size ( );
+        return s;
+    }
+
+    // Write access, marks the tile dirty [it's recompressed on eviction], also if the reference is only read.
+    template<typename... Indices>
+    [[nodiscard]] reference at ( Indices const... i_ ) {
+        static_assert ( sizeof...( Indices ) == layout::rank );
+        int const o = offset ( coordinates_type{ static_cast<int> ( i_ )... } );
+        line & l    = fetch ( o / TileSize );
+        l.dirty     = true;
+        return l.data[ o % TileSize ];
+    }
+
+    template<typename... Indices>
+    [[nodiscard]] value_type at ( Indices const... i_ ) const {
+        static_assert ( sizeof...( Indices ) == layout::rank );
+        int const o = offset ( coordinates_type{ static_cast<int> ( i_ )... } );
+        return fetch ( o / TileSize ).data[ o % TileSize ];
+    }
+
+    // Read access, marks nothing, also on a non-const Compressed.
+    template<typename... Indices>
+    [[nodiscard]] value_type get ( Indices const... i_ ) const {
+        return at ( i_... );
+    }
+
+    template<typename... Indices>
+    [[nodiscard]] reference fat ( Indices const... i_ ) {
+        return at ( i_... );
+    }
+
+    template<typename... Indices>
+    [[nodiscard]] value_type fat ( Indices const... i_ ) const {
+        return at ( i_... );
+    }
+};
+
+} // namespace sax
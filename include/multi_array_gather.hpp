@@ -0,0 +1,332 @@
+
+// MIT License
+//
+// Copyright (c) 2019, 2020 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cassert> // assert
+#include <cstddef> // std::size_t
+#include <cstdint> // std::int32_t, std::int64_t
+
+#include <array>
+#include <span>
+#include <type_traits>
+
+#if defined( __AVX2__ )
+#    include <immintrin.h>
+#endif
+
+#include "multi_array.hpp"
+
+// Batched random access: gather, accumulate, scatter and scatter_add over lists of base-adjusted coordinates, either as
+//  an array of coordinates (AoS) or as one span of indices per dimension (SoA). Single lookups are dependent cache
+//  misses, batching them [and prefetching Distance lookups ahead] lets the memory system work on many at once.
+
+namespace sax {
+
+inline constexpr int default_prefetch_distance = 16;
+
+namespace detail {
+
+template<typename T>
+inline void prefetch_read ( T const * p_ ) noexcept {
+#if defined( __GNUC__ ) || defined( __clang__ )
+    __builtin_prefetch ( p_, 0, 3 );
+#elif defined( __AVX2__ )
+    _mm_prefetch ( reinterpret_cast<char const *> ( p_ ), _MM_HINT_T0 );
+#endif
+}
+
+template<typename T>
+inline void prefetch_write ( T const * p_ ) noexcept {
+#if defined( __GNUC__ ) || defined( __clang__ )
+    __builtin_prefetch ( p_, 1, 3 );
+#elif defined( __AVX2__ )
+    _mm_prefetch ( reinterpret_cast<char const *> ( p_ ), _MM_HINT_T0 );
+#endif
+}
+
+template<typename Array>
+using soa_t = std::array<std::span<int const>, layout<Array>::rank>;
+
+// Offsets (into data ( )) of lookups, from an array of coordinates.
+template<typename Array>
+struct aos_offsets {
+
+    std::span<coordinates_t<Array> const> c;
+
+    [[nodiscard]] std::size_t size ( ) const noexcept { return c.size ( ); }
+    [[nodiscard]] int operator[] ( std::size_t n_ ) const noexcept { return layout<Array>::offset ( c[ n_ ] ); }
+
+#if defined( __AVX2__ )
+    [[nodiscard]] __m256i load8 ( std::size_t n_ ) const noexcept {
+        alignas ( 32 ) int o[ 8 ];
+        for ( int l = 0; l < 8; ++l )
+            o[ l ] = layout<Array>::offset ( c[ n_ + l ] );
+        return _mm256_load_si256 ( reinterpret_cast<__m256i const *> ( o ) );
+    }
+#endif
+};
+
+// Offsets (into data ( )) of lookups, from a span of indices per dimension.
+template<typename Array>
+struct soa_offsets {
+
+    soa_t<Array> c;
+
+    [[nodiscard]] std::size_t size ( ) const noexcept {
+        for ( auto const & s : c )
+            assert ( s.size ( ) == c[ 0 ].size ( ) );
+        return c[ 0 ].size ( );
+    }
+    [[nodiscard]] int operator[] ( std::size_t n_ ) const noexcept {
+        coordinates_t<Array> i;
+        for ( int r = 0; r < layout<Array>::rank; ++r )
+            i[ r ] = c[ r ][ n_ ];
+        return layout<Array>::offset ( i );
+    }
+
+#if defined( __AVX2__ )
+    [[nodiscard]] __m256i load8 ( std::size_t n_ ) const noexcept {
+        __m256i o = _mm256_set1_epi32 ( layout<Array>::rebase );
+        for ( int r = 0; r < layout<Array>::rank - 1; ++r ) {
+            __m256i const i = _mm256_loadu_si256 ( reinterpret_cast<__m256i const *> ( c[ r ].data ( ) + n_ ) );
+            o = _mm256_add_epi32 ( o, _mm256_mullo_epi32 ( i, _mm256_set1_epi32 ( layout<Array>::strides[ r ] ) ) );
+        }
+        // Unit stride.
+        return _mm256_add_epi32 (
+            o, _mm256_loadu_si256 ( reinterpret_cast<__m256i const *> ( c[ layout<Array>::rank - 1 ].data ( ) + n_ ) ) );
+    }
+#endif
+};
+
+template<int Distance, bool Write, typename T, typename Offsets>
+inline void prefetch8 ( T const * p_, Offsets const & o_, std::size_t n_ ) noexcept {
+    if constexpr ( Distance > 0 ) {
+        std::size_t const e = n_ + Distance + 8 < o_.size ( ) ? n_ + Distance + 8 : o_.size ( );
+        for ( std::size_t a = n_ + Distance; a < e; ++a ) {
+            if constexpr ( Write )
+                prefetch_write ( p_ + o_[ a ] );
+            else
+                prefetch_read ( p_ + o_[ a ] );
+        }
+    }
+}
+
+template<int Distance, typename T, typename Offsets>
+void gather ( T const * p_, Offsets const & o_, T * out_ ) noexcept {
+    std::size_t const s = o_.size ( );
+    std::size_t n       = 0;
+#if defined( __AVX2__ )
+    if constexpr ( 4 == sizeof ( T ) ) {
+        for ( ; n + 8 <= s; n += 8 ) {
+            prefetch8<Distance, false> ( p_, o_, n );
+            _mm256_storeu_si256 ( reinterpret_cast<__m256i *> ( out_ + n ),
+                                  _mm256_i32gather_epi32 ( reinterpret_cast<int const *> ( p_ ), o_.load8 ( n ), 4 ) );
+        }
+    }
+    else if constexpr ( 8 == sizeof ( T ) ) {
+        for ( ; n + 8 <= s; n += 8 ) {
+            prefetch8<Distance, false> ( p_, o_, n );
+            __m256i const o = o_.load8 ( n );
+            _mm256_storeu_si256 ( reinterpret_cast<__m256i *> ( out_ + n ),
+                                  _mm256_i32gather_epi64 ( reinterpret_cast<long long const *> ( p_ ),
+                                                           _mm256_castsi256_si128 ( o ), 8 ) );
+            _mm256_storeu_si256 ( reinterpret_cast<__m256i *> ( out_ + n + 4 ),
+                                  _mm256_i32gather_epi64 ( reinterpret_cast<long long const *> ( p_ ),
+                                                           _mm256_extracti128_si256 ( o, 1 ), 8 ) );
+        }
+    }
+#endif
+    for ( ; n < s; n += 8 ) {
+        prefetch8<Distance, false> ( p_, o_, n );
+        std::size_t const e = n + 8 < s ? n + 8 : s;
+        for ( std::size_t a = n; a < e; ++a )
+            out_[ a ] = p_[ o_[ a ] ];
+    }
+}
+
+template<int Distance, typename Acc, typename T, typename Offsets>
+[[nodiscard]] Acc accumulate ( T const * p_, Offsets const & o_ ) noexcept {
+    std::size_t const s = o_.size ( );
+    std::size_t n       = 0;
+    Acc a{ };
+#if defined( __AVX2__ )
+    if constexpr ( std::is_same_v<Acc, T> and std::is_same_v<T, float> ) {
+        __m256 v = _mm256_setzero_ps ( );
+        for ( ; n + 8 <= s; n += 8 ) {
+            prefetch8<Distance, false> ( p_, o_, n );
+            v = _mm256_add_ps ( v, _mm256_i32gather_ps ( p_, o_.load8 ( n ), 4 ) );
+        }
+        alignas ( 32 ) float l[ 8 ];
+        _mm256_store_ps ( l, v );
+        for ( float const f : l )
+            a += f;
+    }
+    else if constexpr ( std::is_same_v<Acc, T> and std::is_same_v<T, double> ) {
+        __m256d v = _mm256_setzero_pd ( );
+        for ( ; n + 8 <= s; n += 8 ) {
+            prefetch8<Distance, false> ( p_, o_, n );
+            __m256i const o = o_.load8 ( n );
+            v = _mm256_add_pd ( v, _mm256_i32gather_pd ( p_, _mm256_castsi256_si128 ( o ), 8 ) );
+            v = _mm256_add_pd ( v, _mm256_i32gather_pd ( p_, _mm256_extracti128_si256 ( o, 1 ), 8 ) );
+        }
+        alignas ( 32 ) double l[ 4 ];
+        _mm256_store_pd ( l, v );
+        for ( double const d : l )
+            a += d;
+    }
+    else if constexpr ( std::is_same_v<Acc, T> and std::is_integral_v<T> and 4 == sizeof ( T ) ) {
+        __m256i v = _mm256_setzero_si256 ( );
+        for ( ; n + 8 <= s; n += 8 ) {
+            prefetch8<Distance, false> ( p_, o_, n );
+            v = _mm256_add_epi32 ( v, _mm256_i32gather_epi32 ( reinterpret_cast<int const *> ( p_ ), o_.load8 ( n ), 4 ) );
+        }
+        alignas ( 32 ) T l[ 8 ];
+        _mm256_store_si256 ( reinterpret_cast<__m256i *> ( l ), v );
+        for ( T const i : l )
+            a += i;
+    }
+    else if constexpr ( std::is_integral_v<Acc> and 8 == sizeof ( Acc ) and std::is_integral_v<T> and 8 == sizeof ( T ) ) {
+        __m256i v = _mm256_setzero_si256 ( );
+        for ( ; n + 8 <= s; n += 8 ) {
+            prefetch8<Distance, false> ( p_, o_, n );
+            __m256i const o = o_.load8 ( n );
+            v = _mm256_add_epi64 (
+                v, _mm256_i32gather_epi64 ( reinterpret_cast<long long const *> ( p_ ), _mm256_castsi256_si128 ( o ), 8 ) );
+            v = _mm256_add_epi64 (
+                v, _mm256_i32gather_epi64 ( reinterpret_cast<long long const *> ( p_ ), _mm256_extracti128_si256 ( o, 1 ), 8 ) );
+        }
+        alignas ( 32 ) Acc l[ 4 ];
+        _mm256_store_si256 ( reinterpret_cast<__m256i *> ( l ), v );
+        for ( Acc const i : l )
+            a += i;
+    }
+    else if constexpr ( std::is_integral_v<Acc> and 8 == sizeof ( Acc ) and std::is_integral_v<T> and 4 == sizeof ( T ) ) {
+        // Widen in-register, so summing many 32-bit values into a 64-bit accumulator does not overflow.
+        __m256i v = _mm256_setzero_si256 ( );
+        for ( ; n + 8 <= s; n += 8 ) {
+            prefetch8<Distance, false> ( p_, o_, n );
+            __m256i const g = _mm256_i32gather_epi32 ( reinterpret_cast<int const *> ( p_ ), o_.load8 ( n ), 4 );
+            if constexpr ( std::is_signed_v<T> ) {
+                v = _mm256_add_epi64 ( v, _mm256_cvtepi32_epi64 ( _mm256_castsi256_si128 ( g ) ) );
+                v = _mm256_add_epi64 ( v, _mm256_cvtepi32_epi64 ( _mm256_extracti128_si256 ( g, 1 ) ) );
+            }
+            else {
+                v = _mm256_add_epi64 ( v, _mm256_cvtepu32_epi64 ( _mm256_castsi256_si128 ( g ) ) );
+                v = _mm256_add_epi64 ( v, _mm256_cvtepu32_epi64 ( _mm256_extracti128_si256 ( g, 1 ) ) );
+            }
+        }
+        alignas ( 32 ) Acc l[ 4 ];
+        _mm256_store_si256 ( reinterpret_cast<__m256i *> ( l ), v );
+        for ( Acc const i : l )
+            a += i;
+    }
+#endif
+    for ( ; n < s; n += 8 ) {
+        prefetch8<Distance, false> ( p_, o_, n );
+        std::size_t const e = n + 8 < s ? n + 8 : s;
+        for ( std::size_t b = n; b < e; ++b )
+            a += static_cast<Acc> ( p_[ o_[ b ] ] );
+    }
+    return a;
+}
+
+// There is no scatter in AVX2, the stores are scalar, the win comes from prefetching [for write] ahead.
+template<int Distance, bool Add, typename T, typename Offsets>
+void scatter ( T * p_, Offsets const & o_, T const * in_ ) noexcept {
+    std::size_t const s = o_.size ( );
+    for ( std::size_t n = 0; n < s; n += 8 ) {
+        prefetch8<Distance, true> ( p_, o_, n );
+        std::size_t const e = n + 8 < s ? n + 8 : s;
+        for ( std::size_t a = n; a < e; ++a ) {
+            if constexpr ( Add )
+                p_[ o_[ a ] ] += in_[ a ]; // In order, duplicate coordinates accumulate.
+            else
+                p_[ o_[ a ] ] = in_[ a ]; // In order, the last of duplicate coordinates wins.
+        }
+    }
+}
+
+} // namespace detail
+
+// out_[ n ] = a_.at ( c_[ n ] ).
+template<int Distance = default_prefetch_distance, typename Array>
+void gather ( Array const & a_, std::span<coordinates_t<Array> const> c_, std::span<typename Array::value_type> out_ ) noexcept {
+    assert ( out_.size ( ) >= c_.size ( ) );
+    detail::gather<Distance> ( a_.data ( ), detail::aos_offsets<Array>{ c_ }, out_.data ( ) );
+}
+
+// out_[ n ] = a_.at ( c_[ 0 ][ n ], c_[ 1 ][ n ], .. ).
+template<int Distance = default_prefetch_distance, typename Array>
+void gather ( Array const & a_, detail::soa_t<Array> const & c_, std::span<typename Array::value_type> out_ ) noexcept {
+    detail::soa_offsets<Array> const o{ c_ };
+    assert ( out_.size ( ) >= o.size ( ) );
+    detail::gather<Distance> ( a_.data ( ), o, out_.data ( ) );
+}
+
+// Sum over n of a_.at ( c_[ n ] ), summed in Acc.
+template<typename Acc = void, int Distance = default_prefetch_distance, typename Array>
+[[nodiscard]] auto accumulate ( Array const & a_, std::span<coordinates_t<Array> const> c_ ) noexcept {
+    using acc_type = std::conditional_t<std::is_void_v<Acc>, typename Array::value_type, Acc>;
+    return detail::accumulate<Distance, acc_type> ( a_.data ( ), detail::aos_offsets<Array>{ c_ } );
+}
+
+// Sum over n of a_.at ( c_[ 0 ][ n ], c_[ 1 ][ n ], .. ), summed in Acc.
+template<typename Acc = void, int Distance = default_prefetch_distance, typename Array>
+[[nodiscard]] auto accumulate ( Array const & a_, detail::soa_t<Array> const & c_ ) noexcept {
+    using acc_type = std::conditional_t<std::is_void_v<Acc>, typename Array::value_type, Acc>;
+    return detail::accumulate<Distance, acc_type> ( a_.data ( ), detail::soa_offsets<Array>{ c_ } );
+}
+
+// a_.at ( c_[ n ] ) = in_[ n ].
+template<int Distance = default_prefetch_distance, typename Array>
+void scatter ( Array & a_, std::span<coordinates_t<Array> const> c_, std::span<typename Array::value_type const> in_ ) noexcept {
+    assert ( in_.size ( ) >= c_.size ( ) );
+    detail::scatter<Distance, false> ( a_.data ( ), detail::aos_offsets<Array>{ c_ }, in_.data ( ) );
+}
+
+// a_.at ( c_[ 0 ][ n ], c_[ 1 ][ n ], .. ) = in_[ n ].
+template<int Distance = default_prefetch_distance, typename Array>
+void scatter ( Array & a_, detail::soa_t<Array> const & c_, std::span<typename Array::value_type const> in_ ) noexcept {
+    detail::soa_offsets<Array> const o{ c_ };
+    assert ( in_.size ( ) >= o.size ( ) );
+    detail::scatter<Distance, false> ( a_.data ( ), o, in_.data ( ) );
+}
+
+// a_.at ( c_[ n ] ) += in_[ n ].
+template<int Distance = default_prefetch_distance, typename Array>
+void scatter_add ( Array & a_, std::span<coordinates_t<Array> const> c_,
+                   std::span<typename Array::value_type const> in_ ) noexcept {
+    assert ( in_.size ( ) >= c_.size ( ) );
+    detail::scatter<Distance, true> ( a_.data ( ), detail::aos_offsets<Array>{ c_ }, in_.data ( ) );
+}
+
+// a_.at ( c_[ 0 ][ n ], c_[ 1 ][ n ], .. ) += in_[ n ].
+template<int Distance = default_prefetch_distance, typename Array>
+void scatter_add ( Array & a_, detail::soa_t<Array> const & c_, std::span<typename Array::value_type const> in_ ) noexcept {
+    detail::soa_offsets<Array> const o{ c_ };
+    assert ( in_.size ( ) >= o.size ( ) );
+    detail::scatter<Distance, true> ( a_.data ( ), o, in_.data ( ) );
+}
+
+} // namespace sax
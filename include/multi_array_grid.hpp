@@ -0,0 +1,451 @@
+
+// MIT License
+//
+// Copyright (c) 2019, 2020 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cmath>   // std::sqrt
+#include <cstddef> // std::size_t
+#include <cstdint> // std::uint64_t
+
+#include <algorithm> // std::fill
+#include <array>
+#include <bit> // std::countr_zero
+#include <limits>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include "multi_array.hpp"
+#include "multi_array_parallel.hpp"
+
+// Algorithms on the grid graph of any Vector, Matrix, Cube or HyperCube: the cells are the vertices, neighbouring
+//  cells are connected if both pass a predicate [pass_ ( value )]. The neighbourhood is either face [4 in 2-D, 6 in
+//  3-D] or full [8 in 2-D, 26 in 3-D]. Coordinates are base-adjusted, the outputs are arrays with the same extents and
+//  bases as the input [f.e. a Matrix<int, I, J, BaseI, BaseJ> for the distances or labels of a Matrix<T, I, J, BaseI,
+//  BaseJ>].
+//
+//  bfs ( ) is level-synchronous, the frontier and the visited cells are bitsets, only the words spanned by the frontier
+//  are scanned. flood_fill ( ) fills whole runs along the last dimension, pushing one seed per run on the neighbouring
+//  lines. label ( ) is union-find, the slabs are split over the threads, which label their part independently, the
+//  parts are merged at their boundaries afterwards. distance_transform ( ) is the exact Euclidean distance transform of
+//  Felzenszwalb and Huttenlocher, one linear pass per dimension, parallel over the lines. chamfer ( ) is the classic
+//  two-pass (3-4-5) chamfer distance.
+
+namespace sax {
+
+enum class neighborhood { face, full };
+
+namespace detail {
+
+template<typename Array, neighborhood Nb>
+struct grid {
+
+    using layout      = detail::layout<Array>;
+    using coordinates = typename layout::coordinates_type;
+
+    static constexpr int rank = layout::rank;
+    static constexpr int size = static_cast<int> ( Array::size ( ) );
+
+    // All combinations of -1, 0, 1 but 0, face neighbours have one non-zero component.
+    static constexpr int combinations = [] ( ) noexcept {
+        int c = 1;
+        for ( int r = 0; r < rank; ++r )
+            c *= 3;
+        return c;
+    }( );
+
+    [[nodiscard]] static constexpr coordinates combination ( int m_ ) noexcept {
+        coordinates d{ };
+        for ( int r = rank - 1; r >= 0; --r, m_ /= 3 )
+            d[ r ] = m_ % 3 - 1;
+        return d;
+    }
+
+    [[nodiscard]] static constexpr int non_zero ( coordinates const & d_ ) noexcept {
+        int n = 0;
+        for ( int r = 0; r < rank; ++r )
+            n += 0 != d_[ r ];
+        return n;
+    }
+
+    static constexpr int count = [] ( ) noexcept {
+        int n = 0;
+        for ( int m = 0; m < combinations; ++m )
+            n += ( neighborhood::full == Nb and non_zero ( combination ( m ) ) ) or 1 == non_zero ( combination ( m ) );
+        return n;
+    }( );
+
+    static constexpr std::array<coordinates, count> deltas = [] ( ) noexcept {
+        std::array<coordinates, count> d{ };
+        int n = 0;
+        for ( int m = 0; m < combinations; ++m )
+            if ( ( neighborhood::full == Nb and non_zero ( combination ( m ) ) ) or 1 == non_zero ( combination ( m ) ) )
+                d[ n++ ] = combination ( m );
+        return d;
+    }( );
+
+    // The flat offsets of the neighbours, in raster order, so the first half is before, the second half after the cell.
+    static constexpr std::array<int, count> offsets = [] ( ) noexcept {
+        std::array<int, count> o{ };
+        for ( int n = 0; n < count; ++n )
+            for ( int r = 0; r < rank; ++r )
+                o[ n ] += deltas[ n ][ r ] * layout::strides[ r ];
+        return o;
+    }( );
+
+    // The zero-based coordinates of offset o_.
+    [[nodiscard]] static constexpr coordinates position ( int o_ ) noexcept {
+        coordinates c;
+        for ( int r = 0; r < rank; ++r ) {
+            c[ r ] = o_ / layout::strides[ r ];
+            o_ %= layout::strides[ r ];
+        }
+        return c;
+    }
+
+    // The next zero-based coordinates in raster order.
+    static constexpr void next ( coordinates & c_ ) noexcept {
+        for ( int r = rank - 1; r >= 0 and ++c_[ r ] == layout::extents[ r ]; --r )
+            if ( r )
+                c_[ r ] = 0;
+    }
+
+    // Whether neighbour n_ of c_ exists.
+    [[nodiscard]] static constexpr bool inside ( coordinates const & c_, int const n_ ) noexcept {
+        for ( int r = 0; r < rank; ++r ) {
+            int const i = c_[ r ] + deltas[ n_ ][ r ];
+            if ( i < 0 or i >= layout::extents[ r ] )
+                return false;
+        }
+        return true;
+    }
+
+    // Whether all neighbours of c_ exist.
+    [[nodiscard]] static constexpr bool interior ( coordinates const & c_ ) noexcept {
+        for ( int r = 0; r < rank; ++r )
+            if ( c_[ r ] < 1 or c_[ r ] > layout::extents[ r ] - 2 )
+                return false;
+        return true;
+    }
+
+    // The zero-based offset of base-adjusted c_.
+    [[nodiscard]] static constexpr int offset ( coordinates const & c_ ) noexcept { return layout::offset ( c_ ); }
+};
+
+template<typename Out, typename Array>
+inline constexpr bool same_layout_v =
+    layout<Out>::extents == layout<Array>::extents and layout<Out>::bases == layout<Array>::bases;
+
+using bitset = std::vector<std::uint64_t>;
+
+[[nodiscard]] inline bool test ( bitset const & b_, int const i_ ) noexcept { return b_[ i_ >> 6 ] >> ( i_ & 63 ) & 1u; }
+inline void set ( bitset & b_, int const i_ ) noexcept { b_[ i_ >> 6 ] |= std::uint64_t{ 1 } << ( i_ & 63 ); }
+
+// Union-find, the root is the smallest element.
+[[nodiscard]] inline int find ( int * p_, int i_ ) noexcept {
+    while ( p_[ i_ ] != i_ ) {
+        p_[ i_ ] = p_[ p_[ i_ ] ]; // Path halving.
+        i_       = p_[ i_ ];
+    }
+    return i_;
+}
+
+inline void unite ( int * p_, int const a_, int const b_ ) noexcept {
+    int a = find ( p_, a_ ), b = find ( p_, b_ );
+    if ( a != b )
+        a < b ? p_[ b ] = a : p_[ a ] = b;
+}
+
+// The 1-D squared Euclidean distance transform of f_, into d_, v_ and z_ are scratch [n_ and n_ + 1 elements]. The
+//  values of f_ should be finite, the lower envelope of the parabolas is computed by differences.
+template<typename T>
+void squared_distance ( T const * f_, T * d_, int const n_, int * v_, T * z_ ) noexcept {
+    constexpr T inf = std::numeric_limits<T>::infinity ( );
+    int k           = 0;
+    v_[ 0 ]         = 0;
+    z_[ 0 ]         = -inf;
+    z_[ 1 ]         = inf;
+    for ( int q = 1; q < n_; ++q ) {
+        T s;
+        for ( ;; --k ) { // Terminates, z_[ 0 ] is -inf.
+            int const p = v_[ k ];
+            s           = ( ( f_[ q ] + T ( q ) * q ) - ( f_[ p ] + T ( p ) * p ) ) / T ( 2 * ( q - p ) );
+            if ( s > z_[ k ] )
+                break;
+        }
+        v_[ ++k ]   = q;
+        z_[ k ]     = s;
+        z_[ k + 1 ] = inf;
+    }
+    k = 0;
+    for ( int q = 0; q < n_; ++q ) {
+        while ( z_[ k + 1 ] < q )
+            ++k;
+        T const e = T ( q - v_[ k ] );
+        d_[ q ]   = e * e + f_[ v_[ k ] ];
+    }
+}
+} // namespace detail
+
+// The number of steps from the nearest of sources_ to every cell, -1 for the cells that can't be reached [or don't
+//  pass], returns the number of cells reached.
+template<neighborhood Nb = neighborhood::face, typename Array, typename Pass, typename Out>
+std::size_t bfs ( Array const & a_, Pass const & pass_, std::span<coordinates_t<Array> const> sources_, Out & distance_ ) {
+    using g = detail::grid<Array, Nb>;
+    using D = typename Out::value_type;
+    static_assert ( detail::same_layout_v<Out, Array> );
+    int const words = ( g::size + 63 ) / 64;
+    detail::bitset visited ( words ), frontier ( words ), next ( words );
+    D * const d = distance_.data ( );
+    std::fill ( d, d + g::size, D ( -1 ) );
+    std::size_t reached = 0;
+    int lo = words, hi = 0;
+    for ( auto const & s : sources_ ) {
+        int const o = g::offset ( s );
+        if ( detail::test ( visited, o ) or not pass_ ( a_.data ( )[ o ] ) )
+            continue;
+        detail::set ( visited, o );
+        detail::set ( frontier, o );
+        d[ o ] = D ( 0 );
+        ++reached;
+        lo = std::min ( lo, o >> 6 );
+        hi = std::max ( hi, ( o >> 6 ) + 1 );
+    }
+    for ( D level = D ( 1 ); lo < hi; ++level ) {
+        int nlo = words, nhi = 0;
+        for ( int w = lo; w < hi; ++w ) {
+            for ( std::uint64_t b = frontier[ w ]; b; b &= b - 1 ) {
+                int const o   = w * 64 + std::countr_zero ( b );
+                auto const c  = g::position ( o );
+                bool const in = g::interior ( c );
+                for ( int n = 0; n < g::count; ++n ) {
+                    if ( not in and not g::inside ( c, n ) )
+                        continue;
+                    int const q = o + g::offsets[ n ];
+                    if ( detail::test ( visited, q ) )
+                        continue;
+                    detail::set ( visited, q ); // Also if it does not pass, it need not be tested again.
+                    if ( not pass_ ( a_.data ( )[ q ] ) )
+                        continue;
+                    detail::set ( next, q );
+                    d[ q ] = level;
+                    ++reached;
+                    nlo = std::min ( nlo, q >> 6 );
+                    nhi = std::max ( nhi, ( q >> 6 ) + 1 );
+                }
+            }
+            frontier[ w ] = 0;
+        }
+        frontier.swap ( next );
+        lo = nlo;
+        hi = nhi;
+    }
+    return reached;
+}
+
+// As above, from a single source.
+template<neighborhood Nb = neighborhood::face, typename Array, typename Pass, typename Out>
+std::size_t bfs ( Array const & a_, Pass const & pass_, coordinates_t<Array> const & source_, Out & distance_ ) {
+    return bfs<Nb> ( a_, pass_, std::span<coordinates_t<Array> const>{ &source_, 1 }, distance_ );
+}
+
+// Sets all cells that pass, connected to seed_, to value_, returns the number of cells set.
+template<neighborhood Nb = neighborhood::face, typename Array, typename Pass>
+std::size_t flood_fill ( Array & a_, coordinates_t<Array> const & seed_, Pass const & pass_,
+                         typename Array::value_type const value_ ) {
+    using g                     = detail::grid<Array, Nb>;
+    constexpr int last          = g::rank - 1;
+    constexpr int length        = g::layout::extents[ last ];
+    constexpr int reach         = neighborhood::full == Nb ? 1 : 0; // Runs on a neighbouring line reach diagonally.
+    auto * const a              = a_.data ( );
+    detail::bitset visited ( ( g::size + 63 ) / 64 );
+    std::vector<int> seeds;
+    std::size_t filled = 0;
+    auto const open    = [ & ] ( int const o_ ) { return not detail::test ( visited, o_ ) and pass_ ( a[ o_ ] ); };
+    if ( int const o = g::offset ( seed_ ); pass_ ( a[ o ] ) )
+        seeds.push_back ( o );
+    while ( not seeds.empty ( ) ) {
+        int const o = seeds.back ( );
+        seeds.pop_back ( );
+        if ( detail::test ( visited, o ) )
+            continue;
+        auto const c = g::position ( o );
+        int const s  = o - c[ last ]; // The start of the line.
+        int l = o, r = o;
+        while ( l > s and open ( l - 1 ) )
+            --l;
+        while ( r < s + length - 1 and open ( r + 1 ) )
+            ++r;
+        for ( int i = l; i <= r; ++i ) {
+            detail::set ( visited, i );
+            a[ i ] = value_;
+        }
+        filled += static_cast<std::size_t> ( r - l + 1 );
+        // The neighbouring lines, the neighbours that don't move along the last dimension.
+        for ( int n = 0; n < g::count; ++n ) {
+            if ( g::deltas[ n ][ last ] or not g::inside ( c, n ) )
+                continue;
+            int const d = g::offsets[ n ], b = std::max ( l - reach, s ) + d, e = std::min ( r + reach, s + length - 1 ) + d;
+            for ( int i = b; i <= e; ++i )
+                if ( open ( i ) and ( i == b or not open ( i - 1 ) ) )
+                    seeds.push_back ( i ); // One per run.
+        }
+    }
+    return filled;
+}
+
+// Labels the connected components of the cells that pass 1, 2, ... [in raster order of their first cell], the other
+//  cells 0, returns the number of components.
+template<neighborhood Nb = neighborhood::face, typename Array, typename Pass, typename Labels>
+int label ( Array const & a_, Pass const & pass_, Labels & labels_, unsigned const threads_ = 0 ) {
+    using g = detail::grid<Array, Nb>;
+    static_assert ( detail::same_layout_v<Labels, Array> );
+    constexpr int slabs = g::layout::extents[ 0 ], slab = g::layout::strides[ 0 ], before = g::count / 2;
+    std::vector<int> parent ( g::size );
+    int * const p = parent.data ( );
+    // Unites the cell o_ with its neighbours before it in [ lo_, hi_ ) that pass.
+    auto const link = [ p ] ( int const o_, typename g::coordinates const & c_, int const lo_, int const hi_ ) noexcept {
+        bool const in = g::interior ( c_ );
+        for ( int n = 0; n < before; ++n ) {
+            int const q = o_ + g::offsets[ n ];
+            if ( ( in or g::inside ( c_, n ) ) and q >= lo_ and q < hi_ and p[ q ] >= 0 )
+                detail::unite ( p, o_, q );
+        }
+    };
+    parallel_for (
+        slabs,
+        [ & ] ( unsigned, std::size_t const b_, std::size_t const e_ ) noexcept {
+            int const b = static_cast<int> ( b_ ) * slab, e = static_cast<int> ( e_ ) * slab;
+            auto c      = g::position ( b );
+            for ( int o = b; o < e; ++o, g::next ( c ) ) {
+                if ( not pass_ ( a_.data ( )[ o ] ) ) {
+                    p[ o ] = -1;
+                    continue;
+                }
+                p[ o ] = o;
+                link ( o, c, b, o ); // Only within the part, the parts don't share cells.
+            }
+        },
+        threads_, 1 );
+    // The first slab of every part, with the last slab of the part before.
+    for ( unsigned t = 1, parts = parallel_partitions ( slabs, threads_, 1 ); t < parts; ++t ) {
+        int const b = static_cast<int> ( detail::partition ( slabs, parts, t ).first ) * slab;
+        auto c      = g::position ( b );
+        for ( int o = b; o < b + slab; ++o, g::next ( c ) )
+            if ( p[ o ] >= 0 )
+                link ( o, c, b - slab, b );
+    }
+    auto * const l = labels_.data ( );
+    int count      = 0;
+    for ( int o = 0; o < g::size; ++o ) {
+        if ( p[ o ] < 0 )
+            l[ o ] = 0;
+        else {
+            int const r = detail::find ( p, o );
+            l[ o ]      = r == o ? ++count : l[ r ]; // The root comes first.
+        }
+    }
+    return count;
+}
+
+// The Euclidean distance from every cell to the nearest cell that is a feature_ ( value ) [infinity if there are
+//  none], or its square.
+template<typename Array, typename Feature, typename Out>
+void distance_transform ( Array const & a_, Feature const & feature_, Out & out_, bool const squared_ = false,
+                          unsigned const threads_ = 0 ) {
+    using layout = detail::layout<Array>;
+    using T      = typename Out::value_type;
+    static_assert ( detail::same_layout_v<Out, Array> and std::is_floating_point_v<T> );
+    constexpr int size = static_cast<int> ( Array::size ( ) );
+    constexpr T far    = T ( 1e20 ); // Finite, beyond any squared distance, becomes infinity at the end.
+    T * const d        = out_.data ( );
+    for ( int o = 0; o < size; ++o )
+        d[ o ] = feature_ ( a_.data ( )[ o ] ) ? T ( 0 ) : far;
+    for ( int r = 0; r < layout::rank; ++r ) {
+        int const n = layout::extents[ r ], s = layout::strides[ r ], lines = size / n;
+        // Per partition, the f, g and z [n + 1] lines and the v line of squared_distance ( ).
+        std::size_t const parts = parallel_partitions ( static_cast<std::size_t> ( lines ), threads_, 64 ), m = 3 * n + 1;
+        std::vector<T> lt ( m * parts );
+        std::vector<int> lv ( static_cast<std::size_t> ( n ) * parts );
+        parallel_for (
+            static_cast<std::size_t> ( lines ),
+            [ & ] ( unsigned const p_, std::size_t const b_, std::size_t const e_ ) noexcept {
+                T * const f = lt.data ( ) + m * p_, * const g = f + n, * const z = g + n;
+                int * const v = lv.data ( ) + static_cast<std::size_t> ( n ) * p_;
+                for ( int q = static_cast<int> ( b_ ); q < static_cast<int> ( e_ ); ++q ) {
+                    T * const line = d + ( q / s ) * s * n + q % s;
+                    bool any       = false;
+                    for ( int i = 0; i < n; ++i ) {
+                        f[ i ] = line[ i * s ];
+                        any    = any or far != f[ i ];
+                    }
+                    if ( not any )
+                        continue; // Stays far.
+                    detail::squared_distance ( f, g, n, v, z );
+                    for ( int i = 0; i < n; ++i )
+                        line[ i * s ] = g[ i ];
+                }
+            },
+            threads_, 64 );
+    }
+    for ( int o = 0; o < size; ++o )
+        d[ o ] = d[ o ] >= far ? std::numeric_limits<T>::infinity ( ) : squared_ ? d[ o ] : std::sqrt ( d[ o ] );
+}
+
+// The chamfer distance from every cell to the nearest cell that is a feature_ ( value ), a step costs weights_[ 0 ]
+//  along an axis, weights_[ 1 ] diagonally in a plane and weights_[ 2 ] diagonally in a cube [the defaults, 3-4-5, are
+//  within some 6% (2-D) to 11% (3-D) of 3 times the Euclidean distance], the maximum value [or infinity] if there are
+//  no features.
+template<typename Array, typename Feature, typename Out>
+void chamfer ( Array const & a_, Feature const & feature_, Out & out_,
+               std::array<typename Out::value_type, 3> const & weights_ = { 3, 4, 5 } ) noexcept {
+    using g = detail::grid<Array, neighborhood::full>;
+    using T = typename Out::value_type;
+    static_assert ( detail::same_layout_v<Out, Array> );
+    using limits = std::numeric_limits<T>;
+    constexpr T far    = limits::has_infinity ? limits::infinity ( ) : limits::max ( );
+    constexpr int half = g::count / 2;
+    T * const d        = out_.data ( );
+    T w[ g::count ];
+    for ( int n = 0; n < g::count; ++n )
+        w[ n ] = weights_[ std::min ( g::non_zero ( g::deltas[ n ] ), 3 ) - 1 ];
+    auto const relax = [ & ] ( int const o_, auto const & c_, int const b_, int const e_ ) noexcept {
+        bool const in = g::interior ( c_ );
+        for ( int n = b_; n < e_; ++n ) {
+            if ( not in and not g::inside ( c_, n ) )
+                continue;
+            T const e = d[ o_ + g::offsets[ n ] ];
+            if ( far != e and e + w[ n ] < d[ o_ ] )
+                d[ o_ ] = e + w[ n ];
+        }
+    };
+    typename g::coordinates c{ };
+    for ( int o = 0; o < g::size; ++o, g::next ( c ) ) {
+        d[ o ] = feature_ ( a_.data ( )[ o ] ) ? T ( 0 ) : far;
+        relax ( o, c, 0, half );
+    }
+    for ( int o = g::size - 1; o >= 0; --o )
+        relax ( o, g::position ( o ), half, g::count );
+}
+
+} // namespace sax
@@ -0,0 +1,360 @@
+
+// MIT License
+//
+// Copyright (c) 2019, 2020 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cassert> // assert
+#include <cstddef> // std::size_t
+#include <cstdint> // std::uint16_t, std::uint32_t
+#include <cstring> // std::memcpy
+
+#include <span>
+#include <type_traits>
+
+#if defined( __F16C__ ) || defined( __AVX2__ )
+#    include <immintrin.h>
+#endif
+
+#include "multi_array.hpp"
+
+// 16-bit floating point storage types, half (IEEE 754 binary16) and bfloat16, for use as the T of any of the containers.
+//  Both convert implicitly to and from float, so at ( ) and friends read as float and assign from float. All computation
+//  is done in float, the bulk functions below (convert, transform, sum, dot) convert 8 elements at a time with F16C
+//  [half] or AVX2 [bfloat16] when available.
+
+namespace sax {
+
+namespace detail {
+
+[[nodiscard]] inline std::uint32_t float_bits ( float const f_ ) noexcept {
+    std::uint32_t u;
+    std::memcpy ( &u, &f_, sizeof ( u ) );
+    return u;
+}
+
+[[nodiscard]] inline float bits_float ( std::uint32_t const u_ ) noexcept {
+    float f;
+    std::memcpy ( &f, &u_, sizeof ( f ) );
+    return f;
+}
+
+// Round to nearest even, overflow to infinity, nan stays (quiet) nan.
+[[nodiscard]] inline std::uint16_t float_to_half ( float const f_ ) noexcept {
+#if defined( __F16C__ )
+    return static_cast<std::uint16_t> ( _cvtss_sh ( f_, _MM_FROUND_TO_NEAREST_INT ) );
+#else
+    std::uint32_t const u    = float_bits ( f_ );
+    std::uint16_t const sign = static_cast<std::uint16_t> ( ( u >> 16 ) & 0x8000u );
+    std::uint32_t const a    = u & 0x7FFF'FFFFu;
+    if ( a >= 0x7F80'0000u ) // Inf or nan.
+        return sign | ( a > 0x7F80'0000u ? 0x7E00u : 0x7C00u );
+    if ( a >= 0x4780'0000u ) // Overflow (>= 65536).
+        return sign | 0x7C00u;
+    if ( a < 0x3880'0000u ) { // Subnormal or zero (< 2^-14), let the fpu do the rounding.
+        return sign | static_cast<std::uint16_t> ( float_bits ( bits_float ( a ) + 0.5f ) - 0x3F00'0000u );
+    }
+    std::uint32_t const m = a + 0xC800'0FFFu + ( ( a >> 13 ) & 1u ); // Rebias ( -112 << 23 ) and round.
+    return sign | static_cast<std::uint16_t> ( m >> 13 );
+#endif
+}
+
+[[nodiscard]] inline float half_to_float ( std::uint16_t const h_ ) noexcept {
+#if defined( __F16C__ )
+    return _cvtsh_ss ( h_ );
+#else
+    std::uint32_t const sign = static_cast<std::uint32_t> ( h_ & 0x8000u ) << 16;
+    std::uint32_t const a    = static_cast<std::uint32_t> ( h_ & 0x7FFFu ) << 13;
+    if ( a >= 0x0F80'0000u ) // Inf or nan.
+        return bits_float ( sign | a | 0x7F80'0000u );
+    if ( a < 0x0080'0000u ) // Subnormal or zero, scale by 2^-24 (exact).
+        return bits_float ( sign | float_bits ( static_cast<float> ( h_ & 0x03FFu ) * 5.9604644775390625e-8f ) );
+    return bits_float ( sign | ( a + 0x3800'0000u ) ); // Rebias ( 112 << 23 ).
+#endif
+}
+
+// Round to nearest even, nan stays (quiet) nan.
+[[nodiscard]] inline std::uint16_t float_to_bfloat16 ( float const f_ ) noexcept {
+    std::uint32_t const u = float_bits ( f_ );
+    if ( ( u & 0x7FFF'FFFFu ) > 0x7F80'0000u )
+        return static_cast<std::uint16_t> ( ( u >> 16 ) | 0x0040u );
+    return static_cast<std::uint16_t> ( ( u + 0x7FFFu + ( ( u >> 16 ) & 1u ) ) >> 16 );
+}
+
+[[nodiscard]] inline float bfloat16_to_float ( std::uint16_t const b_ ) noexcept {
+    return bits_float ( static_cast<std::uint32_t> ( b_ ) << 16 );
+}
+} // namespace detail
+
+class half {
+
+    std::uint16_t m_bits;
+
+    public:
+    half ( ) noexcept = default;
+    half ( float const f_ ) noexcept : m_bits{ detail::float_to_half ( f_ ) } {}
+
+    [[nodiscard]] operator float ( ) const noexcept { return detail::half_to_float ( m_bits ); }
+
+    half & operator+= ( float const f_ ) noexcept { return *this = float{ *this } + f_; }
+    half & operator-= ( float const f_ ) noexcept { return *this = float{ *this } - f_; }
+    half & operator*= ( float const f_ ) noexcept { return *this = float{ *this } * f_; }
+    half & operator/= ( float const f_ ) noexcept { return *this = float{ *this } / f_; }
+
+    [[nodiscard]] constexpr std::uint16_t bits ( ) const noexcept { return m_bits; }
+    [[nodiscard]] static constexpr half from_bits ( std::uint16_t const b_ ) noexcept {
+        half h;
+        h.m_bits = b_;
+        return h;
+    }
+};
+
+class bfloat16 {
+
+    std::uint16_t m_bits;
+
+    public:
+    bfloat16 ( ) noexcept = default;
+    bfloat16 ( float const f_ ) noexcept : m_bits{ detail::float_to_bfloat16 ( f_ ) } {}
+
+    [[nodiscard]] operator float ( ) const noexcept { return detail::bfloat16_to_float ( m_bits ); }
+
+    bfloat16 & operator+= ( float const f_ ) noexcept { return *this = float{ *this } + f_; }
+    bfloat16 & operator-= ( float const f_ ) noexcept { return *this = float{ *this } - f_; }
+    bfloat16 & operator*= ( float const f_ ) noexcept { return *this = float{ *this } * f_; }
+    bfloat16 & operator/= ( float const f_ ) noexcept { return *this = float{ *this } / f_; }
+
+    [[nodiscard]] constexpr std::uint16_t bits ( ) const noexcept { return m_bits; }
+    [[nodiscard]] static constexpr bfloat16 from_bits ( std::uint16_t const b_ ) noexcept {
+        bfloat16 b;
+        b.m_bits = b_;
+        return b;
+    }
+};
+
+static_assert ( sizeof ( half ) == 2 and std::is_trivially_copyable_v<half> );
+static_assert ( sizeof ( bfloat16 ) == 2 and std::is_trivially_copyable_v<bfloat16> );
+
+namespace detail {
+
+template<typename T>
+inline constexpr bool is_f16_v = std::is_same_v<std::remove_const_t<T>, half> or std::is_same_v<std::remove_const_t<T>, bfloat16>;
+
+template<typename T>
+inline constexpr bool is_f32_computable_v = is_f16_v<T> or std::is_same_v<std::remove_const_t<T>, float>;
+
+// Widen n_ elements to float.
+template<typename S>
+inline void load_f32 ( S const * s_, float * f_, std::size_t const n_ ) noexcept {
+    std::size_t i = 0;
+    if constexpr ( std::is_same_v<S, float> ) {
+        std::memcpy ( f_, s_, n_ * sizeof ( float ) );
+        return;
+    }
+#if defined( __F16C__ )
+    else if constexpr ( std::is_same_v<S, half> ) {
+        for ( ; i + 8 <= n_; i += 8 )
+            _mm256_storeu_ps ( f_ + i, _mm256_cvtph_ps ( _mm_loadu_si128 ( reinterpret_cast<__m128i const *> ( s_ + i ) ) ) );
+    }
+#endif
+#if defined( __AVX2__ )
+    else if constexpr ( std::is_same_v<S, bfloat16> ) {
+        for ( ; i + 8 <= n_; i += 8 ) {
+            __m256i const w = _mm256_cvtepu16_epi32 ( _mm_loadu_si128 ( reinterpret_cast<__m128i const *> ( s_ + i ) ) );
+            _mm256_storeu_si256 ( reinterpret_cast<__m256i *> ( f_ + i ), _mm256_slli_epi32 ( w, 16 ) );
+        }
+    }
+#endif
+    for ( std::size_t e = n_ - i; e; --e, ++i )
+        f_[ i ] = s_[ i ];
+}
+
+// Narrow n_ floats.
+template<typename D>
+inline void store_f32 ( float const * f_, D * d_, std::size_t const n_ ) noexcept {
+    std::size_t i = 0;
+    if constexpr ( std::is_same_v<D, float> ) {
+        std::memcpy ( d_, f_, n_ * sizeof ( float ) );
+        return;
+    }
+#if defined( __F16C__ )
+    else if constexpr ( std::is_same_v<D, half> ) {
+        for ( ; i + 8 <= n_; i += 8 )
+            _mm_storeu_si128 ( reinterpret_cast<__m128i *> ( d_ + i ),
+                               _mm256_cvtps_ph ( _mm256_loadu_ps ( f_ + i ), _MM_FROUND_TO_NEAREST_INT ) );
+    }
+#endif
+#if defined( __AVX2__ )
+    else if constexpr ( std::is_same_v<D, bfloat16> ) {
+        __m256i const one = _mm256_set1_epi32 ( 1 ), bias = _mm256_set1_epi32 ( 0x7FFF );
+        __m256i const quiet = _mm256_set1_epi32 ( 0x0040'0000 );
+        for ( ; i + 8 <= n_; i += 8 ) {
+            __m256 const f  = _mm256_loadu_ps ( f_ + i );
+            __m256i const u = _mm256_castps_si256 ( f );
+            __m256i r = _mm256_add_epi32 ( u, _mm256_add_epi32 ( bias, _mm256_and_si256 ( _mm256_srli_epi32 ( u, 16 ), one ) ) );
+            // Nan's are not rounded [which could turn them into inf], but quieted.
+            __m256i const nan = _mm256_castps_si256 ( _mm256_cmp_ps ( f, f, _CMP_UNORD_Q ) );
+            r                 = _mm256_blendv_epi8 ( r, _mm256_or_si256 ( u, quiet ), nan );
+            r = _mm256_srli_epi32 ( r, 16 );
+            // Pack 2 x 4 words, in-lane, then gather the lo quad-words of both lanes.
+            __m256i const p = _mm256_permute4x64_epi64 ( _mm256_packus_epi32 ( r, r ), 0b1000 );
+            _mm_storeu_si128 ( reinterpret_cast<__m128i *> ( d_ + i ), _mm256_castsi256_si128 ( p ) );
+        }
+    }
+#endif
+    for ( std::size_t e = n_ - i; e; --e, ++i )
+        d_[ i ] = f_[ i ];
+}
+
+// Floats per chunk of the bulk functions below, small enough for the buffers to stay in L1.
+inline constexpr std::size_t f32_chunk = 256;
+
+[[nodiscard]] inline float sum_f32 ( float const * f_, std::size_t const n_ ) noexcept {
+    float s[ 8 ] = { };
+    std::size_t i = 0;
+    for ( ; i + 8 <= n_; i += 8 )
+        for ( int l = 0; l < 8; ++l )
+            s[ l ] += f_[ i + l ];
+    for ( std::size_t e = n_ - i; e; --e, ++i )
+        s[ 0 ] += f_[ i ];
+    return ( ( s[ 0 ] + s[ 1 ] ) + ( s[ 2 ] + s[ 3 ] ) ) + ( ( s[ 4 ] + s[ 5 ] ) + ( s[ 6 ] + s[ 7 ] ) );
+}
+
+[[nodiscard]] inline float dot_f32 ( float const * a_, float const * b_, std::size_t const n_ ) noexcept {
+    float s[ 8 ] = { };
+    std::size_t i = 0;
+    for ( ; i + 8 <= n_; i += 8 )
+        for ( int l = 0; l < 8; ++l )
+            s[ l ] += a_[ i + l ] * b_[ i + l ];
+    for ( std::size_t e = n_ - i; e; --e, ++i )
+        s[ 0 ] += a_[ i ] * b_[ i ];
+    return ( ( s[ 0 ] + s[ 1 ] ) + ( s[ 2 ] + s[ 3 ] ) ) + ( ( s[ 4 ] + s[ 5 ] ) + ( s[ 6 ] + s[ 7 ] ) );
+}
+} // namespace detail
+
+// Element-wise copy, converting between float, half and bfloat16, f.e. Matrix<float, ..> to Matrix<half, ..>.
+template<typename Src, typename Dst>
+void convert ( Src const & src_, Dst & dst_ ) noexcept {
+    auto const s = detail::elements ( src_ );
+    auto const d = detail::elements ( dst_ );
+    using S      = std::remove_const_t<typename decltype ( s )::element_type>;
+    using D      = typename decltype ( d )::element_type;
+    static_assert ( detail::is_f32_computable_v<S> and detail::is_f32_computable_v<D> );
+    assert ( s.size ( ) == d.size ( ) );
+    if constexpr ( std::is_same_v<S, D> ) {
+        std::memcpy ( d.data ( ), s.data ( ), s.size ( ) * sizeof ( S ) );
+    }
+    else if constexpr ( std::is_same_v<S, float> ) {
+        detail::store_f32 ( s.data ( ), d.data ( ), s.size ( ) );
+    }
+    else if constexpr ( std::is_same_v<D, float> ) {
+        detail::load_f32 ( s.data ( ), d.data ( ), s.size ( ) );
+    }
+    else {
+        alignas ( 32 ) float f[ detail::f32_chunk ];
+        for ( std::size_t i = 0; i < s.size ( ); i += detail::f32_chunk ) {
+            std::size_t const n = s.size ( ) - i < detail::f32_chunk ? s.size ( ) - i : detail::f32_chunk;
+            detail::load_f32 ( s.data ( ) + i, f, n );
+            detail::store_f32 ( f, d.data ( ) + i, n );
+        }
+    }
+}
+
+// dst_[ n ] = f_ ( src_[ n ] ), computed in float, f_ is float ( float ).
+template<typename Src, typename Dst, typename F>
+void transform ( Src const & src_, Dst & dst_, F f_ ) noexcept {
+    auto const s = detail::elements ( src_ );
+    auto const d = detail::elements ( dst_ );
+    static_assert ( detail::is_f32_computable_v<typename decltype ( s )::element_type> and
+                    detail::is_f32_computable_v<typename decltype ( d )::element_type> );
+    assert ( s.size ( ) == d.size ( ) );
+    alignas ( 32 ) float f[ detail::f32_chunk ];
+    for ( std::size_t i = 0; i < s.size ( ); i += detail::f32_chunk ) {
+        std::size_t const n = s.size ( ) - i < detail::f32_chunk ? s.size ( ) - i : detail::f32_chunk;
+        detail::load_f32 ( s.data ( ) + i, f, n );
+        for ( std::size_t j = 0; j < n; ++j )
+            f[ j ] = f_ ( f[ j ] );
+        detail::store_f32 ( f, d.data ( ) + i, n );
+    }
+}
+
+// dst_[ n ] = f_ ( a_[ n ], b_[ n ] ), computed in float, f_ is float ( float, float ).
+template<typename A, typename B, typename Dst, typename F>
+void transform ( A const & a_, B const & b_, Dst & dst_, F f_ ) noexcept {
+    auto const a = detail::elements ( a_ );
+    auto const b = detail::elements ( b_ );
+    auto const d = detail::elements ( dst_ );
+    static_assert ( detail::is_f32_computable_v<typename decltype ( a )::element_type> and
+                    detail::is_f32_computable_v<typename decltype ( b )::element_type> and
+                    detail::is_f32_computable_v<typename decltype ( d )::element_type> );
+    assert ( a.size ( ) == b.size ( ) and a.size ( ) == d.size ( ) );
+    alignas ( 32 ) float fa[ detail::f32_chunk ], fb[ detail::f32_chunk ];
+    for ( std::size_t i = 0; i < a.size ( ); i += detail::f32_chunk ) {
+        std::size_t const n = a.size ( ) - i < detail::f32_chunk ? a.size ( ) - i : detail::f32_chunk;
+        detail::load_f32 ( a.data ( ) + i, fa, n );
+        detail::load_f32 ( b.data ( ) + i, fb, n );
+        for ( std::size_t j = 0; j < n; ++j )
+            fa[ j ] = f_ ( fa[ j ], fb[ j ] );
+        detail::store_f32 ( fa, d.data ( ) + i, n );
+    }
+}
+
+// The sum of the elements, in float.
+template<typename Src>
+[[nodiscard]] float sum ( Src const & src_ ) noexcept {
+    auto const s = detail::elements ( src_ );
+    static_assert ( detail::is_f32_computable_v<typename decltype ( s )::element_type> );
+    if constexpr ( std::is_same_v<std::remove_const_t<typename decltype ( s )::element_type>, float> ) {
+        return detail::sum_f32 ( s.data ( ), s.size ( ) );
+    }
+    else {
+        alignas ( 32 ) float f[ detail::f32_chunk ];
+        float r = 0.0f;
+        for ( std::size_t i = 0; i < s.size ( ); i += detail::f32_chunk ) {
+            std::size_t const n = s.size ( ) - i < detail::f32_chunk ? s.size ( ) - i : detail::f32_chunk;
+            detail::load_f32 ( s.data ( ) + i, f, n );
+            r += detail::sum_f32 ( f, n );
+        }
+        return r;
+    }
+}
+
+// The dot-product of the elements, in float.
+template<typename A, typename B>
+[[nodiscard]] float dot ( A const & a_, B const & b_ ) noexcept {
+    auto const a = detail::elements ( a_ );
+    auto const b = detail::elements ( b_ );
+    static_assert ( detail::is_f32_computable_v<typename decltype ( a )::element_type> and
+                    detail::is_f32_computable_v<typename decltype ( b )::element_type> );
+    assert ( a.size ( ) == b.size ( ) );
+    alignas ( 32 ) float fa[ detail::f32_chunk ], fb[ detail::f32_chunk ];
+    float r = 0.0f;
+    for ( std::size_t i = 0; i < a.size ( ); i += detail::f32_chunk ) {
+        std::size_t const n = a.size ( ) - i < detail::f32_chunk ? a.size ( ) - i : detail::f32_chunk;
+        detail::load_f32 ( a.data ( ) + i, fa, n );
+        detail::load_f32 ( b.data ( ) + i, fb, n );
+        r += detail::dot_f32 ( fa, fb, n );
+    }
+    return r;
+}
+
+} // namespace sax
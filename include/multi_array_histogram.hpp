@@ -0,0 +1,202 @@
+
+// MIT License
+//
+// Copyright (c) 2019, 2020 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cassert> // assert
+#include <cstddef> // std::size_t
+
+#include <type_traits>
+#include <vector>
+
+#include "multi_array.hpp"
+#include "multi_array_parallel.hpp"
+
+// Histograms of the elements of any container [or view], added to the bins of a Vector [or, joint, of a Matrix].
+//
+//  bincount ( a, bins ) counts integer values, value v goes into bins.at ( v ), the base of the Vector is the lowest
+//  value counted. histogram ( a, { lo, hi }, bins ) counts values in [ lo, hi ), in equal width bins. Both take optional
+//  weights [an array of the same size as a], the joint variants count pairs [ a[ i ], b[ i ] ] into a Matrix. All of
+//  them return the number of elements [pairs] that fell outside the bins.
+//
+//  Every thread [of parallel_for ( )] counts into its own copy of the bins, so there's no contention, and for up to 1024
+//  bins a thread keeps 4 copies, element i going to copy i % 4, so a run of equal values does not serialize on one
+//  counter. The copies are merged, in parallel over the bins, by vectorized adds.
+
+namespace sax {
+
+struct bin_range {
+    double lo, hi;
+};
+
+namespace detail {
+
+inline constexpr std::size_t histogram_grain = std::size_t{ 1 } << 14;
+
+// Adds to out_ the (weighted) counts of bin_ ( i ) [the zero-based bin of element i, or -1 if it has none] for the
+//  elements [ 0, n_ ), returns the number of elements without a bin.
+template<int Bins, typename Count, typename BinOf, typename WeightOf>
+std::size_t privatized ( std::size_t const n_, BinOf const & bin_, WeightOf const & weight_, Count * out_,
+                         unsigned const threads_ ) {
+    constexpr std::size_t copies = Bins <= 1024 ? 4 : 1, size = copies * Bins;
+    unsigned const parts         = parallel_partitions ( n_, threads_, histogram_grain );
+    std::vector<Count> h ( parts * size );
+    std::vector<std::size_t> outside ( parts );
+    parallel_for (
+        n_,
+        [ & ] ( unsigned const p_, std::size_t const b_, std::size_t const e_ ) noexcept {
+            Count * const c = h.data ( ) + p_ * size;
+            std::size_t o   = 0;
+            for ( std::size_t i = b_; i < e_; ++i ) {
+                int const k = bin_ ( i );
+                if ( k < 0 )
+                    ++o;
+                else
+                    c[ ( i & ( copies - 1 ) ) * Bins + k ] += weight_ ( i );
+            }
+            outside[ p_ ] = o;
+        },
+        threads_, histogram_grain );
+    parallel_for (
+        Bins,
+        [ & ] ( unsigned, std::size_t const b_, std::size_t const e_ ) noexcept {
+            for ( std::size_t c = 0; c < parts * copies; ++c ) {
+                Count const * const s = h.data ( ) + c * Bins;
+                for ( std::size_t j = b_; j < e_; ++j ) // This vectorizes as is.
+                    out_[ j ] += s[ j ];
+            }
+        },
+        threads_, 4096 );
+    std::size_t o = 0;
+    for ( std::size_t const s : outside )
+        o += s;
+    return o;
+}
+
+// The zero-based bin of integer value v_, for Bins bins starting at value Base, or -1.
+template<int Bins, int Base, typename T>
+[[nodiscard]] inline int integer_bin ( T const v_ ) noexcept {
+    static_assert ( std::is_integral_v<T> );
+    long long const d = static_cast<long long> ( v_ ) - Base;
+    return static_cast<unsigned long long> ( d ) < static_cast<unsigned long long> ( Bins ) ? static_cast<int> ( d ) : -1;
+}
+
+// The zero-based bin of v_, for Bins bins of equal width covering r_, or -1 [also for nan's].
+template<int Bins>
+struct range_bin {
+
+    double lo, hi, scale;
+
+    explicit range_bin ( bin_range const & r_ ) noexcept : lo{ r_.lo }, hi{ r_.hi }, scale{ Bins / ( r_.hi - r_.lo ) } {
+        assert ( r_.lo < r_.hi );
+    }
+
+    template<typename T>
+    [[nodiscard]] int operator( ) ( T const v_ ) const noexcept {
+        double const v = static_cast<double> ( v_ );
+        if ( not( v >= lo and v < hi ) )
+            return -1;
+        int const b = static_cast<int> ( ( v - lo ) * scale );
+        return b < Bins ? b : Bins - 1; // Rounding, just below hi.
+    }
+};
+
+template<typename Count>
+struct unit_weight {
+    [[nodiscard]] constexpr Count operator( ) ( std::size_t ) const noexcept { return Count{ 1 }; }
+};
+} // namespace detail
+
+// Counts the integer values of a_ into bins_, value v in bins_.at ( v ).
+template<typename Array, typename T, int N, int Base>
+std::size_t bincount ( Array const & a_, Vector<T, N, Base> & bins_, unsigned const threads_ = 0 ) {
+    auto const a = detail::elements ( a_ );
+    return detail::privatized<N> (
+        a.size ( ), [ a ] ( std::size_t const i_ ) noexcept { return detail::integer_bin<N, Base> ( a[ i_ ] ); },
+        detail::unit_weight<T>{ }, bins_.data ( ), threads_ );
+}
+
+// As above, adding weights_[ i ] for element i.
+template<typename Array, typename Weights, typename T, int N, int Base>
+std::size_t bincount ( Array const & a_, Weights const & weights_, Vector<T, N, Base> & bins_, unsigned const threads_ = 0 ) {
+    auto const a = detail::elements ( a_ );
+    auto const w = detail::elements ( weights_ );
+    assert ( a.size ( ) == w.size ( ) );
+    return detail::privatized<N> (
+        a.size ( ), [ a ] ( std::size_t const i_ ) noexcept { return detail::integer_bin<N, Base> ( a[ i_ ] ); },
+        [ w ] ( std::size_t const i_ ) noexcept { return static_cast<T> ( w[ i_ ] ); }, bins_.data ( ), threads_ );
+}
+
+// Counts the pairs [ a_[ i ], b_[ i ] ] of integer values into bins_, pair [ u, v ] in bins_.at ( u, v ).
+template<typename A, typename B, typename T, int NA, int NB, int BaseA, int BaseB>
+std::size_t bincount ( A const & a_, B const & b_, Matrix<T, NA, NB, BaseA, BaseB> & bins_, unsigned const threads_ = 0 ) {
+    auto const a = detail::elements ( a_ );
+    auto const b = detail::elements ( b_ );
+    assert ( a.size ( ) == b.size ( ) );
+    return detail::privatized<NA * NB> (
+        a.size ( ),
+        [ a, b ] ( std::size_t const i_ ) noexcept {
+            int const u = detail::integer_bin<NA, BaseA> ( a[ i_ ] ), v = detail::integer_bin<NB, BaseB> ( b[ i_ ] );
+            return u < 0 or v < 0 ? -1 : u * NB + v;
+        },
+        detail::unit_weight<T>{ }, bins_.data ( ), threads_ );
+}
+
+// Counts the values of a_ in r_ into bins_, which divide r_ in N equal parts.
+template<typename Array, typename T, int N, int Base>
+std::size_t histogram ( Array const & a_, bin_range const & r_, Vector<T, N, Base> & bins_, unsigned const threads_ = 0 ) {
+    auto const a = detail::elements ( a_ );
+    return detail::privatized<N> (
+        a.size ( ), [ a, f = detail::range_bin<N>{ r_ } ] ( std::size_t const i_ ) noexcept { return f ( a[ i_ ] ); },
+        detail::unit_weight<T>{ }, bins_.data ( ), threads_ );
+}
+
+// As above, adding weights_[ i ] for element i.
+template<typename Array, typename Weights, typename T, int N, int Base>
+std::size_t histogram ( Array const & a_, bin_range const & r_, Weights const & weights_, Vector<T, N, Base> & bins_,
+                        unsigned const threads_ = 0 ) {
+    auto const a = detail::elements ( a_ );
+    auto const w = detail::elements ( weights_ );
+    assert ( a.size ( ) == w.size ( ) );
+    return detail::privatized<N> (
+        a.size ( ), [ a, f = detail::range_bin<N>{ r_ } ] ( std::size_t const i_ ) noexcept { return f ( a[ i_ ] ); },
+        [ w ] ( std::size_t const i_ ) noexcept { return static_cast<T> ( w[ i_ ] ); }, bins_.data ( ), threads_ );
+}
+
+// Counts the pairs [ a_[ i ], b_[ i ] ] in ra_ x rb_ into bins_, which divide ra_ x rb_ in NA x NB equal parts.
+template<typename A, typename B, typename T, int NA, int NB, int BaseA, int BaseB>
+std::size_t histogram ( A const & a_, bin_range const & ra_, B const & b_, bin_range const & rb_,
+                        Matrix<T, NA, NB, BaseA, BaseB> & bins_, unsigned const threads_ = 0 ) {
+    auto const a = detail::elements ( a_ );
+    auto const b = detail::elements ( b_ );
+    assert ( a.size ( ) == b.size ( ) );
+    return detail::privatized<NA * NB> (
+        a.size ( ),
+        [ a, b, f = detail::range_bin<NA>{ ra_ }, g = detail::range_bin<NB>{ rb_ } ] ( std::size_t const i_ ) noexcept {
+            int const u = f ( a[ i_ ] ), v = g ( b[ i_ ] );
+            return u < 0 or v < 0 ? -1 : u * NB + v;
+        },
+        detail::unit_weight<T>{ }, bins_.data ( ), threads_ );
+}
+
+} // namespace sax
@@ -0,0 +1,463 @@
+
+// MIT License
+//
+// Copyright (c) 2019, 2020 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cassert> // assert
+#include <cerrno>  // EIO, EINTR, EAGAIN
+#include <cstddef> // std::size_t, std::byte
+#include <cstdint> // std::uint64_t
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <thread>
+#include <utility> // std::pair
+#include <vector>
+
+#if defined( _WIN32 )
+#    include <windows.h>
+#else
+#    include <unistd.h> // pread, pwrite
+#    if defined( __linux__ )
+#        include <linux/io_uring.h>
+#        include <sys/mman.h>
+#        include <sys/syscall.h>
+#    endif
+#endif
+
+#include "multi_array.hpp"
+
+// Asynchronous, chunked, loading and storing of the (raw) elements of an Array [or view] from and to a file, at some
+//  offset. The Array is split into chunks of whole slabs [rows of a Matrix, planes of a Cube], which are all issued at
+//  once, on Linux through io_uring [without liburing], elsewhere [or if the kernel refuses, or predates 5.6] by a small
+//  pool of threads doing positional reads and writes. The returned async_transfer has a std::shared_future per chunk, so
+//  slab i can be processed as soon as wait ( chunk_of ( i ) ) returns, while later chunks are still in flight.
+//
+//  The Array should outlive the async_transfer [its destructor waits for all chunks] and a chunk should not be touched
+//  before it's ready. The file handle is not owned. The futures hold 0 on success, a negative error code [-errno, on
+//  Windows -GetLastError ( )] otherwise, reading beyond the end of the file is -EIO.
+
+namespace sax {
+
+enum class io_backend { automatic, uring, threads };
+
+struct io_options {
+    std::size_t chunk_bytes = std::size_t{ 1 } << 22; // Rounded up to whole slabs.
+    unsigned queue_depth    = 32;                     // The io_uring requests in flight.
+    unsigned threads        = 4;                      // The threads of the fallback.
+    io_backend backend      = io_backend::automatic;
+};
+
+#if defined( _WIN32 )
+using native_file_handle = HANDLE;
+#else
+using native_file_handle = int;
+#endif
+
+namespace detail {
+
+struct io_request {
+    std::byte * data;
+    std::uint64_t offset;
+    std::size_t bytes;
+    bool write;
+};
+
+// The largest single read or write.
+inline constexpr std::size_t io_max_bytes = std::size_t{ 1 } << 30;
+
+// Blocking, positional, transfer of all of r_.
+[[nodiscard]] inline int transfer ( native_file_handle const h_, io_request r_ ) noexcept {
+    while ( r_.bytes ) {
+        std::size_t const b = r_.bytes < io_max_bytes ? r_.bytes : io_max_bytes;
+#if defined( _WIN32 )
+        OVERLAPPED o{ };
+        o.Offset     = static_cast<DWORD> ( r_.offset );
+        o.OffsetHigh = static_cast<DWORD> ( r_.offset >> 32 );
+        DWORD k      = 0;
+        if ( not( r_.write ? WriteFile ( h_, r_.data, static_cast<DWORD> ( b ), &k, &o )
+                           : ReadFile ( h_, r_.data, static_cast<DWORD> ( b ), &k, &o ) ) ) {
+            DWORD const e = GetLastError ( );
+            return ERROR_HANDLE_EOF == e ? -EIO : -static_cast<int> ( e );
+        }
+#else
+        ssize_t const k = r_.write ? ::pwrite ( h_, r_.data, b, static_cast<off_t> ( r_.offset ) )
+                                   : ::pread ( h_, r_.data, b, static_cast<off_t> ( r_.offset ) );
+        if ( k < 0 ) {
+            if ( EINTR == errno )
+                continue;
+            return -errno;
+        }
+#endif
+        if ( not k )
+            return -EIO;
+        r_.data += k;
+        r_.offset += static_cast<std::uint64_t> ( k );
+        r_.bytes -= static_cast<std::size_t> ( k );
+    }
+    return 0;
+}
+
+#if defined( __linux__ )
+
+// The bare minimum of an io_uring, one submitter, one reaper.
+class uring {
+
+    int m_fd = -1;
+    void * m_sq_ring       = MAP_FAILED;
+    void * m_cq_ring       = MAP_FAILED;
+    std::size_t m_sq_bytes = 0, m_cq_bytes = 0, m_sqes_bytes = 0;
+    io_uring_sqe * m_sqes = static_cast<io_uring_sqe *> ( MAP_FAILED );
+    unsigned * m_sq_tail = nullptr, * m_sq_array = nullptr, m_sq_mask = 0;
+    unsigned * m_cq_head = nullptr, * m_cq_tail = nullptr, m_cq_mask = 0;
+    io_uring_cqe * m_cqes = nullptr;
+    unsigned m_entries = 0, m_pending = 0;
+
+    template<typename T>
+    [[nodiscard]] static T * at ( void * const p_, unsigned const o_ ) noexcept {
+        return reinterpret_cast<T *> ( static_cast<char *> ( p_ ) + o_ );
+    }
+
+    public:
+    uring ( ) noexcept = default;
+    uring ( uring const & ) = delete;
+    uring & operator= ( uring const & ) = delete;
+
+    ~uring ( ) noexcept {
+        if ( MAP_FAILED != static_cast<void *> ( m_sqes ) )
+            munmap ( m_sqes, m_sqes_bytes );
+        if ( MAP_FAILED != m_cq_ring and m_cq_ring != m_sq_ring )
+            munmap ( m_cq_ring, m_cq_bytes );
+        if ( MAP_FAILED != m_sq_ring )
+            munmap ( m_sq_ring, m_sq_bytes );
+        if ( m_fd >= 0 )
+            close ( m_fd );
+    }
+
+    [[nodiscard]] bool open ( unsigned const entries_ ) noexcept {
+        io_uring_params p{ };
+        m_fd = static_cast<int> ( syscall ( __NR_io_uring_setup, entries_, &p ) );
+        if ( m_fd < 0 )
+            return false;
+        m_sq_bytes = p.sq_off.array + p.sq_entries * sizeof ( unsigned );
+        m_cq_bytes = p.cq_off.cqes + p.cq_entries * sizeof ( io_uring_cqe );
+        if ( p.features & IORING_FEAT_SINGLE_MMAP )
+            m_sq_bytes = m_cq_bytes = m_sq_bytes > m_cq_bytes ? m_sq_bytes : m_cq_bytes;
+        m_sq_ring = mmap ( nullptr, m_sq_bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQ_RING );
+        if ( MAP_FAILED == m_sq_ring )
+            return false;
+        m_cq_ring = p.features & IORING_FEAT_SINGLE_MMAP
+                        ? m_sq_ring
+                        : mmap ( nullptr, m_cq_bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_CQ_RING );
+        if ( MAP_FAILED == m_cq_ring )
+            return false;
+        m_sqes_bytes = p.sq_entries * sizeof ( io_uring_sqe );
+        m_sqes       = static_cast<io_uring_sqe *> (
+            mmap ( nullptr, m_sqes_bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQES ) );
+        if ( MAP_FAILED == static_cast<void *> ( m_sqes ) )
+            return false;
+        m_sq_tail  = at<unsigned> ( m_sq_ring, p.sq_off.tail );
+        m_sq_array = at<unsigned> ( m_sq_ring, p.sq_off.array );
+        m_sq_mask  = *at<unsigned> ( m_sq_ring, p.sq_off.ring_mask );
+        m_cq_head  = at<unsigned> ( m_cq_ring, p.cq_off.head );
+        m_cq_tail  = at<unsigned> ( m_cq_ring, p.cq_off.tail );
+        m_cq_mask  = *at<unsigned> ( m_cq_ring, p.cq_off.ring_mask );
+        m_cqes     = at<io_uring_cqe> ( m_cq_ring, p.cq_off.cqes );
+        m_entries  = p.sq_entries;
+        return supports ( IORING_OP_READ ) and supports ( IORING_OP_WRITE );
+    }
+
+    // Whether the kernel knows op_ [IORING_OP_READ and IORING_OP_WRITE arrived in 5.6, io_uring itself in 5.1], a kernel
+    //  without IORING_REGISTER_PROBE [also 5.6] knows neither.
+    [[nodiscard]] bool supports ( unsigned const op_ ) const noexcept {
+        constexpr unsigned n = IORING_OP_LAST;
+        // Zeroed, as the kernel demands.
+        alignas ( io_uring_probe ) std::byte b[ sizeof ( io_uring_probe ) + n * sizeof ( io_uring_probe_op ) ]{ };
+        if ( syscall ( __NR_io_uring_register, m_fd, IORING_REGISTER_PROBE, b, n ) < 0 )
+            return false;
+        io_uring_probe const * const p = reinterpret_cast<io_uring_probe const *> ( b );
+        return op_ < n and op_ <= p->last_op and p->ops[ op_ ].flags & IO_URING_OP_SUPPORTED;
+    }
+
+    [[nodiscard]] unsigned entries ( ) const noexcept { return m_entries; }
+
+    // Queues (a part, of at most io_max_bytes, of) r_, the caller keeps the requests in flight below entries ( ).
+    void push ( native_file_handle const h_, io_request const & r_, std::uint64_t const user_data_ ) noexcept {
+        unsigned const t = *m_sq_tail, i = t & m_sq_mask; // Only this thread writes the tail.
+        io_uring_sqe & s = m_sqes[ i ];
+        s                = io_uring_sqe{ };
+        s.opcode         = r_.write ? IORING_OP_WRITE : IORING_OP_READ;
+        s.fd             = h_;
+        s.off            = r_.offset;
+        s.addr           = reinterpret_cast<std::uint64_t> ( r_.data );
+        s.len            = static_cast<unsigned> ( r_.bytes < io_max_bytes ? r_.bytes : io_max_bytes );
+        s.user_data      = user_data_;
+        m_sq_array[ i ]  = i;
+        std::atomic_ref<unsigned> ( *m_sq_tail ).store ( t + 1, std::memory_order_release );
+        ++m_pending;
+    }
+
+    // Submits the queued requests and waits for (at least) one completion, 0 or -errno.
+    [[nodiscard]] int submit_and_wait ( ) noexcept {
+        for ( ;; ) {
+            long const r = syscall ( __NR_io_uring_enter, m_fd, m_pending, 1u, IORING_ENTER_GETEVENTS, nullptr, 0 );
+            if ( r >= 0 ) {
+                m_pending -= static_cast<unsigned> ( r );
+                return 0;
+            }
+            if ( EINTR != errno and EAGAIN != errno )
+                return -errno;
+        }
+    }
+
+    // After a failed submit, waits for [and discards] the completions of the in_flight_ pushed requests, the ones never
+    //  submitted are dropped. Nothing the kernel holds touches the buffers anymore on return.
+    void drain ( unsigned in_flight_ ) noexcept {
+        in_flight_ -= m_pending;
+        m_pending = 0;
+        while ( in_flight_ ) {
+            if ( syscall ( __NR_io_uring_enter, m_fd, 0u, 1u, IORING_ENTER_GETEVENTS, nullptr, 0 ) < 0 and EINTR != errno )
+                std::this_thread::yield ( ); // Can't block, poll the completion queue.
+            reap ( [ & ] ( std::uint64_t, int ) noexcept { --in_flight_; } );
+        }
+    }
+
+    template<typename F>
+    void reap ( F && f_ ) noexcept {
+        unsigned h       = *m_cq_head;
+        unsigned const t = std::atomic_ref<unsigned> ( *m_cq_tail ).load ( std::memory_order_acquire );
+        for ( ; h != t; ++h )
+            f_ ( m_cqes[ h & m_cq_mask ].user_data, m_cqes[ h & m_cq_mask ].res );
+        std::atomic_ref<unsigned> ( *m_cq_head ).store ( h, std::memory_order_release );
+    }
+};
+
+#endif
+
+struct io_state {
+    native_file_handle handle;
+    std::vector<io_request> requests;
+    std::vector<std::promise<int>> done;
+    std::vector<std::shared_future<int>> futures;
+    std::vector<std::thread> workers;
+    std::atomic<std::size_t> next{ 0 };
+#if defined( __linux__ )
+    uring ring;
+
+    // All requests, through the ring, retrying short and interrupted transfers.
+    void run_uring ( ) noexcept {
+        std::size_t const n = requests.size ( );
+        std::vector<io_request> rest{ requests }; // What remains to be done of each request.
+        std::size_t issued = 0, completed = 0;
+        unsigned in_flight = 0;
+        while ( completed < n ) {
+            for ( ; in_flight < ring.entries ( ) and issued < n; ++issued, ++in_flight )
+                ring.push ( handle, rest[ issued ], issued );
+            if ( int const e = ring.submit_and_wait ( ); e ) {
+                // Fatal, the futures only become ready once the kernel is done with the buffers.
+                ring.drain ( in_flight );
+                for ( std::size_t c = 0; c < n; ++c )
+                    if ( rest[ c ].bytes )
+                        done[ c ].set_value ( e );
+                return;
+            }
+            ring.reap ( [ & ] ( std::uint64_t const c_, int const r_ ) noexcept {
+                io_request & r = rest[ c_ ];
+                if ( -EINTR == r_ or -EAGAIN == r_ ) {
+                    ring.push ( handle, r, c_ ); // Stays in flight.
+                    return;
+                }
+                --in_flight;
+                if ( r_ <= 0 ) {
+                    r.bytes = 0;
+                    done[ c_ ].set_value ( r_ ? r_ : -EIO );
+                    ++completed;
+                    return;
+                }
+                r.data += r_;
+                r.offset += static_cast<std::uint64_t> ( r_ );
+                r.bytes -= static_cast<std::size_t> ( r_ );
+                if ( r.bytes ) {
+                    ring.push ( handle, r, c_ );
+                    ++in_flight;
+                }
+                else {
+                    done[ c_ ].set_value ( 0 );
+                    ++completed;
+                }
+            } );
+        }
+    }
+#endif
+
+    // The requests, in order, by whichever worker is free.
+    void run_threads ( ) noexcept {
+        for ( std::size_t c = next++; c < requests.size ( ); c = next++ )
+            done[ c ].set_value ( transfer ( handle, requests[ c ] ) );
+    }
+};
+
+// The elements in a slab [a row of a Matrix, a plane of a Cube], and the base of the slabs.
+template<typename Array>
+[[nodiscard]] constexpr std::pair<std::size_t, int> slab ( ) noexcept {
+    if constexpr ( requires { Array::extents ( ); } )
+        return { Array::size ( ) / layout<Array>::extents[ 0 ], layout<Array>::bases[ 0 ] };
+    else
+        return { 1, 0 };
+}
+} // namespace detail
+
+class async_transfer {
+
+    std::unique_ptr<detail::io_state> m_state;
+    std::size_t m_slabs_per_chunk = 1, m_slabs = 0;
+    int m_base                    = 0;
+    io_backend m_backend          = io_backend::threads;
+
+    public:
+    async_transfer ( ) noexcept = default;
+    async_transfer ( async_transfer && ) noexcept = default;
+    async_transfer & operator= ( async_transfer && o_ ) noexcept {
+        join ( );
+        m_state           = std::move ( o_.m_state );
+        m_slabs_per_chunk = o_.m_slabs_per_chunk;
+        m_slabs           = o_.m_slabs;
+        m_base            = o_.m_base;
+        m_backend         = o_.m_backend;
+        return *this;
+    }
+    ~async_transfer ( ) noexcept { join ( ); }
+
+    async_transfer ( native_file_handle const h_, std::byte * const data_, std::size_t const slabs_,
+                     std::size_t const slab_bytes_, int const base_, std::uint64_t const offset_, bool const write_,
+                     io_options const & o_ ) :
+        m_state{ std::make_unique<detail::io_state> ( ) },
+        m_slabs{ slabs_ }, m_base{ base_ } {
+        std::size_t const b = slab_bytes_ ? slab_bytes_ : 1;
+        m_slabs_per_chunk   = o_.chunk_bytes > b ? ( o_.chunk_bytes + b - 1 ) / b : 1;
+        detail::io_state & s = *m_state;
+        s.handle             = h_;
+        for ( std::size_t i = 0; i < slabs_; i += m_slabs_per_chunk ) {
+            std::size_t const e = i + m_slabs_per_chunk < slabs_ ? i + m_slabs_per_chunk : slabs_;
+            s.requests.push_back ( { data_ + i * b, offset_ + i * b, ( e - i ) * b, write_ } );
+        }
+        s.done.resize ( s.requests.size ( ) );
+        for ( std::promise<int> & p : s.done )
+            s.futures.push_back ( p.get_future ( ).share ( ) );
+        if ( s.requests.empty ( ) )
+            return;
+#if defined( __linux__ )
+        if ( io_backend::threads != o_.backend and s.ring.open ( o_.queue_depth ? o_.queue_depth : 1 ) ) {
+            m_backend = io_backend::uring;
+            s.workers.emplace_back ( [ &s ] ( ) noexcept { s.run_uring ( ); } );
+            return;
+        }
+#endif
+        unsigned const t = o_.threads ? o_.threads : 1;
+        for ( unsigned w = 0; w < t and w < s.requests.size ( ); ++w )
+            s.workers.emplace_back ( [ &s ] ( ) noexcept { s.run_threads ( ); } );
+    }
+
+    // The backend doing the transfers.
+    [[nodiscard]] io_backend backend ( ) const noexcept { return m_backend; }
+
+    [[nodiscard]] std::size_t chunks ( ) const noexcept { return m_state ? m_state->futures.size ( ) : 0; }
+
+    // The chunk holding (base-adjusted) slab i_.
+    [[nodiscard]] std::size_t chunk_of ( int const i_ ) const noexcept {
+        assert ( i_ >= m_base and static_cast<std::size_t> ( i_ - m_base ) < m_slabs );
+        return static_cast<std::size_t> ( i_ - m_base ) / m_slabs_per_chunk;
+    }
+
+    // The (base-adjusted) slabs [ b, e ) of chunk c_.
+    [[nodiscard]] std::pair<int, int> slabs ( std::size_t const c_ ) const noexcept {
+        std::size_t const b = c_ * m_slabs_per_chunk, e = b + m_slabs_per_chunk < m_slabs ? b + m_slabs_per_chunk : m_slabs;
+        return { static_cast<int> ( b ) + m_base, static_cast<int> ( e ) + m_base };
+    }
+
+    [[nodiscard]] std::shared_future<int> const & future ( std::size_t const c_ ) const noexcept {
+        return m_state->futures[ c_ ];
+    }
+
+    [[nodiscard]] bool ready ( std::size_t const c_ ) const {
+        return std::future_status::ready == future ( c_ ).wait_for ( std::chrono::seconds{ 0 } );
+    }
+
+    // Waits for chunk c_.
+    int wait ( std::size_t const c_ ) const { return future ( c_ ).get ( ); }
+
+    // Waits for all chunks, the first error, if any.
+    int wait ( ) const {
+        int e = 0;
+        for ( std::size_t c = 0, n = chunks ( ); c < n; ++c )
+            if ( int const r = wait ( c ); r and not e )
+                e = r;
+        return e;
+    }
+
+    private:
+    void join ( ) noexcept {
+        if ( m_state )
+            for ( std::thread & w : m_state->workers )
+                w.join ( );
+        m_state.reset ( );
+    }
+};
+
+// Reads the elements of a_ from h_, starting at offset_.
+template<typename Array>
+[[nodiscard]] async_transfer load_async ( native_file_handle const h_, Array & a_, std::uint64_t const offset_ = 0,
+                                          io_options const & o_ = { } ) {
+    auto const e = detail::elements ( a_ );
+    using T      = typename decltype ( e )::element_type;
+    static_assert ( not std::is_const_v<T> and std::is_trivially_copyable_v<T> );
+    constexpr auto s = detail::slab<std::remove_const_t<Array>> ( );
+    return { h_, reinterpret_cast<std::byte *> ( e.data ( ) ), e.size ( ) / s.first, s.first * sizeof ( T ), s.second, offset_,
+             false, o_ };
+}
+
+// Writes the elements of a_ to h_, starting at offset_.
+template<typename Array>
+[[nodiscard]] async_transfer store_async ( native_file_handle const h_, Array const & a_, std::uint64_t const offset_ = 0,
+                                           io_options const & o_ = { } ) {
+    auto const e = detail::elements ( a_ );
+    using T      = std::remove_const_t<typename decltype ( e )::element_type>;
+    static_assert ( std::is_trivially_copyable_v<T> );
+    constexpr auto s = detail::slab<std::remove_const_t<Array>> ( );
+    return { h_, reinterpret_cast<std::byte *> ( const_cast<T *> ( e.data ( ) ) ), e.size ( ) / s.first, s.first * sizeof ( T ),
+             s.second, offset_, true, o_ };
+}
+
+// The blocking equivalents, 0 or the first error.
+template<typename Array>
+int load ( native_file_handle const h_, Array & a_, std::uint64_t const offset_ = 0, io_options const & o_ = { } ) {
+    return load_async ( h_, a_, offset_, o_ ).wait ( );
+}
+template<typename Array>
+int store ( native_file_handle const h_, Array const & a_, std::uint64_t const offset_ = 0, io_options const & o_ = { } ) {
+    return store_async ( h_, a_, offset_, o_ ).wait ( );
+}
+
+} // namespace sax
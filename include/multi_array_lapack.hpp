@@ -0,0 +1,320 @@
+
+// MIT License
+//
+// Copyright (c) 2019, 2020 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cmath>   // std::abs, std::sqrt
+#include <cstddef> // std::size_t
+
+#include <type_traits>
+#include <utility> // std::swap
+
+#if defined( SAX_MA_USE_CBLAS ) && __has_include( <cblas.h> )
+#    include <cblas.h>
+#    define MA_HAS_CBLAS 1
+#endif
+#if defined( SAX_MA_USE_LAPACKE ) && __has_include( <lapacke.h> )
+#    include <lapacke.h>
+#    define MA_HAS_LAPACKE 1
+#endif
+
+#include "multi_array.hpp"
+
+// Dense linear algebra on (row-major) Matrix's [and Vector's as right hand sides]: gemm, gemv, getrf, getrs, gesv and
+//  potrf, with the semantics of their BLAS/LAPACK namesakes. Define SAX_MA_USE_CBLAS and/or SAX_MA_USE_LAPACKE [and link
+//  the libraries] to have large float and double problems dispatched to the installed CBLAS/LAPACKE, all others [and
+//  everything without those libraries] use the built-in kernels. Everything operates on data ( ) in place, nothing is
+//  copied. Pivots are returned as base-adjusted row indices, ipiv_.at ( i ) is the row that was swapped with row i.
+//
+//  The factorizations and solvers return the LAPACK info value, 0 on success, i > 0 if the i-th (1-based) pivot is zero
+//  [getrf, gesv] or the i-th leading minor is not positive definite [potrf].
+
+namespace sax {
+
+// Multiply-adds from which on gemm and gemv go to the BLAS.
+inline constexpr std::size_t blas_threshold = 32 * 32 * 32;
+// Order from which on the factorizations go to LAPACK.
+inline constexpr int lapack_threshold = 64;
+
+namespace detail {
+
+template<typename T>
+inline constexpr bool is_blas_type_v = std::is_same_v<T, float> or std::is_same_v<T, double>;
+
+// The rows and columns of a Matrix, a Vector is a column.
+template<typename Array>
+inline constexpr int rows_v = layout<Array>::extents[ 0 ];
+template<typename Array>
+inline constexpr int columns_v = 2 == layout<Array>::rank ? layout<Array>::extents[ layout<Array>::rank - 1 ] : 1;
+
+// C = alpha A B + beta C, A is M x K, B is K x N, all row-major and densely packed.
+template<typename T>
+void gemm_kernel ( int const m_, int const n_, int const k_, T const alpha_, T const * a_, T const * b_, T const beta_,
+                   T * c_ ) noexcept {
+    constexpr int kc = 256, nc = 512; // Keep a K x N block of B in L2.
+    for ( int i = 0; i < m_; ++i ) {
+        T * const c = c_ + static_cast<std::size_t> ( i ) * n_;
+        if ( T{ } == beta_ ) {
+            for ( int j = 0; j < n_; ++j )
+                c[ j ] = T{ }; // Do not read C, it might hold nan's.
+        }
+        else if ( T{ 1 } != beta_ ) {
+            for ( int j = 0; j < n_; ++j )
+                c[ j ] *= beta_;
+        }
+    }
+    for ( int jb = 0; jb < n_; jb += nc ) {
+        int const je = jb + nc < n_ ? jb + nc : n_;
+        for ( int kb = 0; kb < k_; kb += kc ) {
+            int const ke = kb + kc < k_ ? kb + kc : k_;
+            for ( int i = 0; i < m_; ++i ) {
+                T * const c       = c_ + static_cast<std::size_t> ( i ) * n_;
+                T const * const a = a_ + static_cast<std::size_t> ( i ) * k_;
+                for ( int k = kb; k < ke; ++k ) {
+                    T const aik       = alpha_ * a[ k ];
+                    T const * const b = b_ + static_cast<std::size_t> ( k ) * n_;
+                    for ( int j = jb; j < je; ++j )
+                        c[ j ] += aik * b[ j ];
+                }
+            }
+        }
+    }
+}
+
+// In place LU-factorization, with partial pivoting, of the n x n A, p_[ i ] is the (0-based) row swapped with row i.
+template<typename T>
+[[nodiscard]] int getrf_kernel ( int const n_, T * a_, int * p_ ) noexcept {
+    int info = 0;
+    for ( int k = 0; k < n_; ++k ) {
+        T * const ak = a_ + static_cast<std::size_t> ( k ) * n_;
+        int p        = k;
+        T m          = std::abs ( ak[ k ] );
+        for ( int i = k + 1; i < n_; ++i ) {
+            T const v = std::abs ( a_[ static_cast<std::size_t> ( i ) * n_ + k ] );
+            if ( v > m )
+                m = v, p = i;
+        }
+        p_[ k ] = p;
+        if ( p != k ) {
+            T * const ap = a_ + static_cast<std::size_t> ( p ) * n_;
+            for ( int j = 0; j < n_; ++j )
+                std::swap ( ak[ j ], ap[ j ] );
+        }
+        if ( T{ } == ak[ k ] ) {
+            if ( not info )
+                info = k + 1;
+            continue;
+        }
+        T const r = T{ 1 } / ak[ k ];
+        for ( int i = k + 1; i < n_; ++i ) {
+            T * const ai = a_ + static_cast<std::size_t> ( i ) * n_;
+            T const l    = ai[ k ] *= r;
+            for ( int j = k + 1; j < n_; ++j )
+                ai[ j ] -= l * ak[ j ];
+        }
+    }
+    return info;
+}
+
+// Solves A X = B, for the LU-factorized n x n A, B [overwritten by X] is n x nrhs.
+template<typename T>
+void getrs_kernel ( int const n_, int const nrhs_, T const * a_, int const * p_, T * b_ ) noexcept {
+    for ( int k = 0; k < n_; ++k ) {
+        if ( p_[ k ] != k ) {
+            T * const bk = b_ + static_cast<std::size_t> ( k ) * nrhs_;
+            T * const bp = b_ + static_cast<std::size_t> ( p_[ k ] ) * nrhs_;
+            for ( int j = 0; j < nrhs_; ++j )
+                std::swap ( bk[ j ], bp[ j ] );
+        }
+    }
+    for ( int i = 1; i < n_; ++i ) { // L, unit diagonal.
+        T * const bi = b_ + static_cast<std::size_t> ( i ) * nrhs_;
+        for ( int k = 0; k < i; ++k ) {
+            T const l          = a_[ static_cast<std::size_t> ( i ) * n_ + k ];
+            T const * const bk = b_ + static_cast<std::size_t> ( k ) * nrhs_;
+            for ( int j = 0; j < nrhs_; ++j )
+                bi[ j ] -= l * bk[ j ];
+        }
+    }
+    for ( int i = n_ - 1; i >= 0; --i ) { // U.
+        T * const bi = b_ + static_cast<std::size_t> ( i ) * nrhs_;
+        for ( int k = i + 1; k < n_; ++k ) {
+            T const u          = a_[ static_cast<std::size_t> ( i ) * n_ + k ];
+            T const * const bk = b_ + static_cast<std::size_t> ( k ) * nrhs_;
+            for ( int j = 0; j < nrhs_; ++j )
+                bi[ j ] -= u * bk[ j ];
+        }
+        T const r = T{ 1 } / a_[ static_cast<std::size_t> ( i ) * n_ + i ];
+        for ( int j = 0; j < nrhs_; ++j )
+            bi[ j ] *= r;
+    }
+}
+
+// In place Cholesky-factorization, A = L L^T, L in the lower triangle, the strict upper triangle is not referenced.
+template<typename T>
+[[nodiscard]] int potrf_kernel ( int const n_, T * a_ ) noexcept {
+    for ( int j = 0; j < n_; ++j ) {
+        T * const aj = a_ + static_cast<std::size_t> ( j ) * n_;
+        T d          = aj[ j ];
+        for ( int k = 0; k < j; ++k )
+            d -= aj[ k ] * aj[ k ];
+        if ( not( d > T{ } ) )
+            return j + 1;
+        d       = std::sqrt ( d );
+        aj[ j ] = d;
+        T const r = T{ 1 } / d;
+        for ( int i = j + 1; i < n_; ++i ) {
+            T * const ai = a_ + static_cast<std::size_t> ( i ) * n_;
+            T s          = ai[ j ];
+            for ( int k = 0; k < j; ++k )
+                s -= ai[ k ] * aj[ k ];
+            ai[ j ] = s * r;
+        }
+    }
+    return 0;
+}
+
+// Pivots, 0-based <-> base-adjusted.
+template<typename P>
+void rebase_pivots ( P & p_, int const from_, int const to_ ) noexcept {
+    for ( int & p : p_ )
+        p += to_ - from_;
+}
+} // namespace detail
+
+// C = alpha A B + beta C.
+template<typename A, typename B, typename C>
+void gemm ( A const & a_, B const & b_, C & c_, typename C::value_type const alpha_ = 1,
+            typename C::value_type const beta_ = 0 ) noexcept {
+    using T        = typename C::value_type;
+    constexpr int m = detail::rows_v<C>, n = detail::columns_v<C>, k = detail::columns_v<A>;
+    static_assert ( std::is_same_v<typename A::value_type, T> and std::is_same_v<typename B::value_type, T> );
+    static_assert ( detail::rows_v<A> == m and detail::rows_v<B> == k and detail::columns_v<B> == n );
+#if defined( MA_HAS_CBLAS )
+    if constexpr ( detail::is_blas_type_v<T> and static_cast<std::size_t> ( m ) * n * k >= blas_threshold ) {
+        if constexpr ( std::is_same_v<T, float> )
+            cblas_sgemm ( CblasRowMajor, CblasNoTrans, CblasNoTrans, m, n, k, alpha_, a_.data ( ), k, b_.data ( ), n, beta_,
+                          c_.data ( ), n );
+        else
+            cblas_dgemm ( CblasRowMajor, CblasNoTrans, CblasNoTrans, m, n, k, alpha_, a_.data ( ), k, b_.data ( ), n, beta_,
+                          c_.data ( ), n );
+        return;
+    }
+#endif
+    detail::gemm_kernel ( m, n, k, alpha_, a_.data ( ), b_.data ( ), beta_, c_.data ( ) );
+}
+
+// y = alpha A x + beta y.
+template<typename A, typename X, typename Y>
+void gemv ( A const & a_, X const & x_, Y & y_, typename Y::value_type const alpha_ = 1,
+            typename Y::value_type const beta_ = 0 ) noexcept {
+    using T        = typename Y::value_type;
+    constexpr int m = detail::rows_v<A>, n = detail::columns_v<A>;
+    static_assert ( std::is_same_v<typename A::value_type, T> and std::is_same_v<typename X::value_type, T> );
+    static_assert ( 1 == detail::layout<X>::rank and 1 == detail::layout<Y>::rank );
+    static_assert ( detail::rows_v<X> == n and detail::rows_v<Y> == m );
+#if defined( MA_HAS_CBLAS )
+    if constexpr ( detail::is_blas_type_v<T> and static_cast<std::size_t> ( m ) * n >= blas_threshold ) {
+        if constexpr ( std::is_same_v<T, float> )
+            cblas_sgemv ( CblasRowMajor, CblasNoTrans, m, n, alpha_, a_.data ( ), n, x_.data ( ), 1, beta_, y_.data ( ), 1 );
+        else
+            cblas_dgemv ( CblasRowMajor, CblasNoTrans, m, n, alpha_, a_.data ( ), n, x_.data ( ), 1, beta_, y_.data ( ), 1 );
+        return;
+    }
+#endif
+    detail::gemm_kernel ( m, 1, n, alpha_, a_.data ( ), x_.data ( ), beta_, y_.data ( ) );
+}
+
+// LU-factorization, in place, with partial pivoting, P A = L U.
+template<typename A, typename P>
+[[nodiscard]] int getrf ( A & a_, P & ipiv_ ) noexcept {
+    constexpr int n = detail::rows_v<A>, base = detail::layout<A>::bases[ 0 ];
+    static_assert ( detail::columns_v<A> == n and std::is_same_v<typename P::value_type, int> and P::size ( ) == n );
+#if defined( MA_HAS_LAPACKE )
+    using T = typename A::value_type;
+    if constexpr ( detail::is_blas_type_v<T> and n >= lapack_threshold and sizeof ( lapack_int ) == sizeof ( int ) ) {
+        int info;
+        if constexpr ( std::is_same_v<T, float> )
+            info = static_cast<int> ( LAPACKE_sgetrf ( LAPACK_ROW_MAJOR, n, n, a_.data ( ), n, ipiv_.data ( ) ) );
+        else
+            info = static_cast<int> ( LAPACKE_dgetrf ( LAPACK_ROW_MAJOR, n, n, a_.data ( ), n, ipiv_.data ( ) ) );
+        detail::rebase_pivots ( ipiv_, 1, base );
+        return info;
+    }
+#endif
+    int const info = detail::getrf_kernel ( n, a_.data ( ), ipiv_.data ( ) );
+    detail::rebase_pivots ( ipiv_, 0, base );
+    return info;
+}
+
+// Solves A X = B, given the factorization of getrf, B [a Matrix, or a Vector] is overwritten by X.
+template<typename A, typename P, typename B>
+void getrs ( A const & a_, P const & ipiv_, B & b_ ) noexcept {
+    using T        = typename A::value_type;
+    constexpr int n = detail::rows_v<A>, nrhs = detail::columns_v<B>, base = detail::layout<A>::bases[ 0 ];
+    static_assert ( detail::columns_v<A> == n and detail::rows_v<B> == n and std::is_same_v<typename B::value_type, T> );
+    P p = ipiv_;
+#if defined( MA_HAS_LAPACKE )
+    if constexpr ( detail::is_blas_type_v<T> and n >= lapack_threshold and sizeof ( lapack_int ) == sizeof ( int ) ) {
+        detail::rebase_pivots ( p, base, 1 );
+        if constexpr ( std::is_same_v<T, float> )
+            LAPACKE_sgetrs ( LAPACK_ROW_MAJOR, 'N', n, nrhs, a_.data ( ), n, p.data ( ), b_.data ( ), nrhs );
+        else
+            LAPACKE_dgetrs ( LAPACK_ROW_MAJOR, 'N', n, nrhs, a_.data ( ), n, p.data ( ), b_.data ( ), nrhs );
+        return;
+    }
+#endif
+    detail::rebase_pivots ( p, base, 0 );
+    detail::getrs_kernel ( n, nrhs, a_.data ( ), p.data ( ), b_.data ( ) );
+}
+
+// Solves A X = B, A is overwritten by its factorization [as getrf], B by X.
+template<typename A, typename P, typename B>
+[[nodiscard]] int gesv ( A & a_, P & ipiv_, B & b_ ) noexcept {
+    int const info = getrf ( a_, ipiv_ );
+    if ( not info )
+        getrs ( a_, ipiv_, b_ );
+    return info;
+}
+
+// Cholesky-factorization, in place, A = L L^T, L in the lower triangle [the strict upper triangle is not referenced].
+template<typename A>
+[[nodiscard]] int potrf ( A & a_ ) noexcept {
+    constexpr int n = detail::rows_v<A>;
+    static_assert ( detail::columns_v<A> == n );
+#if defined( MA_HAS_LAPACKE )
+    using T = typename A::value_type;
+    if constexpr ( detail::is_blas_type_v<T> and n >= lapack_threshold ) {
+        if constexpr ( std::is_same_v<T, float> )
+            return static_cast<int> ( LAPACKE_spotrf ( LAPACK_ROW_MAJOR, 'L', n, a_.data ( ), n ) );
+        else
+            return static_cast<int> ( LAPACKE_dpotrf ( LAPACK_ROW_MAJOR, 'L', n, a_.data ( ), n ) );
+    }
+#endif
+    return detail::potrf_kernel ( n, a_.data ( ) );
+}
+
+} // namespace sax
+
+#undef MA_HAS_LAPACKE
+#undef MA_HAS_CBLAS
@@ -0,0 +1,109 @@
+
+// MIT License
+//
+// Copyright (c) 2019, 2020 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <array>
+#include <cstddef> // std::size_t
+#include <span>
+#include <type_traits>
+#include <utility> // std::index_sequence
+
+#if __has_include( <mdspan> )
+#    include <mdspan>
+#endif
+
+#if !defined( __cpp_lib_mdspan )
+#    error "multi_array_mdspan.hpp requires C++23 std::mdspan [<mdspan>], which this standard library does not provide"
+#endif
+
+#include "multi_array.hpp"
+
+// Zero-copy conversion of the containers [and views] to std::mdspan (C++23). The extents are static, the layout is
+//  layout_based<Bases...>, which maps exactly like std::layout_right [the index space of a std::mdspan is zero-based,
+//  so std algorithms and m[ i, j ] see a plain row-major mdspan], but also carries the bases, sax::at ( m, i, j )
+//  takes base-adjusted indices, just like the container it came from.
+
+namespace sax {
+
+template<int... Bases>
+struct layout_based {
+
+    template<typename Extents>
+    class mapping : public std::layout_right::mapping<Extents> {
+
+        static_assert ( sizeof...( Bases ) == Extents::rank ( ) );
+
+        using base = std::layout_right::mapping<Extents>;
+
+        public:
+        using extents_type = Extents;
+        using index_type   = typename base::index_type;
+        using size_type    = typename base::size_type;
+        using rank_type    = typename base::rank_type;
+        using layout_type  = layout_based;
+
+        using base::base;
+
+        [[nodiscard]] static constexpr std::array<int, sizeof...( Bases )> bases ( ) noexcept { return { Bases... }; }
+
+        // The offset of the element at base-adjusted indices.
+        template<typename... Indices>
+        [[nodiscard]] constexpr index_type based ( Indices const... i_ ) const noexcept {
+            static_assert ( sizeof...( Indices ) == sizeof...( Bases ) );
+            return base::operator( ) ( static_cast<index_type> ( i_ - Bases )... );
+        }
+    };
+};
+
+namespace detail {
+
+template<typename T, typename Array, std::size_t... R>
+auto mdspan_type ( std::index_sequence<R...> )
+    -> std::mdspan<T, std::extents<int, layout<Array>::extents[ R ]...>, layout_based<layout<Array>::bases[ R ]...>>;
+} // namespace detail
+
+// The std::mdspan type of Array [or VectorView], T is the (possibly const) value_type.
+template<typename Array, typename T = typename Array::value_type>
+using mdspan_t = decltype ( detail::mdspan_type<T, Array> ( std::make_index_sequence<detail::layout<Array>::rank>{ } ) );
+
+template<typename Array>
+[[nodiscard]] auto to_mdspan ( Array & a_ ) noexcept {
+    auto const e = detail::elements ( a_ );
+    return mdspan_t<std::remove_const_t<Array>, typename decltype ( e )::element_type>{ e.data ( ) };
+}
+
+// The views of Cube are plain std::span's, without a base.
+template<typename T, std::size_t Extent>
+[[nodiscard]] auto to_mdspan ( std::span<T, Extent> s_ ) noexcept {
+    return std::mdspan<T, std::extents<std::size_t, Extent>>{ s_.data ( ), s_.size ( ) };
+}
+
+// The element at base-adjusted indices.
+template<typename T, typename Extents, int... Bases, typename Accessor, typename... Indices>
+[[nodiscard]] constexpr typename Accessor::reference at ( std::mdspan<T, Extents, layout_based<Bases...>, Accessor> const & m_,
+                                                          Indices const... i_ ) noexcept {
+    return m_.accessor ( ).access ( m_.data_handle ( ), static_cast<std::size_t> ( m_.mapping ( ).based ( i_... ) ) );
+}
+
+} // namespace sax
@@ -0,0 +1,363 @@
+
+// MIT License
+//
+// Copyright (c) 2019, 2020 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cassert> // assert
+#include <cmath>   // std::sqrt
+#include <cstddef> // std::size_t
+#include <cstring> // std::memcpy
+
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility> // std::pair
+
+#if defined( __AVX2__ )
+#    include <immintrin.h>
+#endif
+
+#include "multi_array.hpp"
+
+// Packed storage for square N x N matrices that are mostly (structurally) zero or redundant, all row-major:
+//
+//  TriangularMatrix<T, N, triangle::lower> stores row i, columns [ 0, i ], in N ( N + 1 ) / 2 elements,
+//  TriangularMatrix<T, N, triangle::upper> stores row i, columns [ i, N ), in N ( N + 1 ) / 2 elements,
+//  SymmetricMatrix<T, N> stores the lower triangle, at ( i, j ) and at ( j, i ) refer to the same element,
+//  BandedMatrix<T, N, KL, KU> stores row i, columns [ i - KL, i + KU ], in N ( KL + KU + 1 ) elements [the corners of
+//   the band are allocated, but never referenced].
+//
+//  at ( i, j ) takes base-adjusted indices, like Matrix, and asserts the element is stored, get ( i, j ) also returns
+//  the (zero) elements that are not. row ( i ) is the contiguous, stored, part of row i, starting at column first ( i ).
+//  The kernels [multiply, solve, factor] only traverse those rows, the inner loops are dot-products and axpy's on
+//  contiguous memory, vectorized for float and double.
+
+#define MA_PACKED_ELEMENTS                                                                                                         \
+    using value_type       = T;                                                                                                    \
+    using pointer          = value_type *;                                                                                         \
+    using const_pointer    = value_type const *;                                                                                   \
+    using reference        = value_type &;                                                                                         \
+    using const_reference  = value_type const &;                                                                                   \
+    using size_type        = std::size_t;                                                                                          \
+    using difference_type  = std::make_signed_t<size_type>;                                                                        \
+    using iterator         = pointer;                                                                                              \
+    using const_iterator   = const_pointer;                                                                                        \
+    using extents_type     = std::tuple<int, int>;                                                                                 \
+                                                                                                                                   \
+    [[nodiscard]] static constexpr std::size_t capacity ( ) noexcept { return size ( ); }                                          \
+    [[nodiscard]] static constexpr extents_type extents ( ) noexcept { return { N, N }; }                                          \
+    [[nodiscard]] static constexpr extents_type bases ( ) noexcept { return { BaseI, BaseJ }; }                                    \
+                                                                                                                                   \
+    [[nodiscard]] constexpr pointer data ( ) noexcept { return m_data; }                                                           \
+    [[nodiscard]] constexpr const_pointer data ( ) const noexcept { return m_data; }                                               \
+                                                                                                                                   \
+    [[nodiscard]] constexpr iterator begin ( ) noexcept { return std::begin ( m_data ); }                                          \
+    [[nodiscard]] constexpr const_iterator begin ( ) const noexcept { return std::cbegin ( m_data ); }                             \
+    [[nodiscard]] constexpr const_iterator cbegin ( ) const noexcept { return std::cbegin ( m_data ); }                            \
+    [[nodiscard]] constexpr iterator end ( ) noexcept { return std::end ( m_data ); }                                              \
+    [[nodiscard]] constexpr const_iterator end ( ) const noexcept { return std::cend ( m_data ); }                                 \
+    [[nodiscard]] constexpr const_iterator cend ( ) const noexcept { return std::cend ( m_data ); }                                \
+                                                                                                                                   \
+    [[nodiscard]] constexpr reference at ( int const i_, int const j_ ) noexcept {                                                 \
+        MA_PACKED_ASSERT                                                                                                           \
+        return m_data[ offset ( i_ - BaseI, j_ - BaseJ ) ];                                                                        \
+    }                                                                                                                              \
+    [[nodiscard]] constexpr value_type at ( int const i_, int const j_ ) const noexcept {                                          \
+        MA_PACKED_ASSERT                                                                                                           \
+        return m_data[ offset ( i_ - BaseI, j_ - BaseJ ) ];                                                                        \
+    }                                                                                                                              \
+                                                                                                                                   \
+    [[nodiscard]] constexpr value_type get ( int const i_, int const j_ ) const noexcept {                                         \
+        return stored ( i_ - BaseI, j_ - BaseJ ) ? m_data[ offset ( i_ - BaseI, j_ - BaseJ ) ] : value_type{ };                    \
+    }                                                                                                                              \
+                                                                                                                                   \
+    /* The (base-adjusted) column of the first stored element of row i_. */                                                      \
+    [[nodiscard]] static constexpr int first ( int const i_ ) noexcept { return columns ( i_ - BaseI ).first + BaseJ; }            \
+                                                                                                                                   \
+    [[nodiscard]] std::span<value_type> row ( int const i_ ) noexcept {                                                            \
+        auto const [ b, e ] = columns ( i_ - BaseI );                                                                              \
+        return { m_data + offset ( i_ - BaseI, b ), static_cast<std::size_t> ( e - b ) };                                          \
+    }                                                                                                                              \
+    [[nodiscard]] std::span<value_type const> row ( int const i_ ) const noexcept {                                                \
+        auto const [ b, e ] = columns ( i_ - BaseI );                                                                              \
+        return { m_data + offset ( i_ - BaseI, b ), static_cast<std::size_t> ( e - b ) };                                          \
+    }
+
+#define MA_PACKED_ASSERT                                                                                                           \
+    assert ( i_ >= BaseI and i_ < N + BaseI );                                                                                     \
+    assert ( j_ >= BaseJ and j_ < N + BaseJ );                                                                                     \
+    assert ( stored ( i_ - BaseI, j_ - BaseJ ) );
+
+namespace sax {
+
+enum class triangle { lower, upper };
+
+template<typename T, int N, triangle Uplo, int BaseI = 0, int BaseJ = 0, typename = detail::is_valid_multi_array_type<T>>
+class TriangularMatrix {
+
+    T m_data[ N * ( N + 1 ) / 2 ];
+
+    public:
+    static constexpr triangle uplo = Uplo;
+
+    [[nodiscard]] static constexpr std::size_t size ( ) noexcept { return N * ( N + 1 ) / 2; }
+
+    // The stored, zero-based, columns [ b, e ) of zero-based row i_.
+    [[nodiscard]] static constexpr std::pair<int, int> columns ( int const i_ ) noexcept {
+        return triangle::lower == Uplo ? std::pair{ 0, i_ + 1 } : std::pair{ i_, N };
+    }
+    [[nodiscard]] static constexpr bool stored ( int const i_, int const j_ ) noexcept {
+        return triangle::lower == Uplo ? j_ <= i_ : j_ >= i_;
+    }
+    [[nodiscard]] static constexpr std::size_t offset ( int const i_, int const j_ ) noexcept {
+        if constexpr ( triangle::lower == Uplo )
+            return static_cast<std::size_t> ( i_ ) * ( i_ + 1 ) / 2 + j_;
+        else
+            return static_cast<std::size_t> ( i_ ) * ( 2 * N - i_ + 1 ) / 2 + ( j_ - i_ );
+    }
+
+    MA_PACKED_ELEMENTS
+
+    TriangularMatrix ( ) noexcept : m_data{ T{} } {}
+    explicit TriangularMatrix ( uninitialized_t ) noexcept {}
+};
+
+template<typename T, int N, int BaseI = 0, int BaseJ = BaseI, typename = detail::is_valid_multi_array_type<T>>
+class SymmetricMatrix {
+
+    T m_data[ N * ( N + 1 ) / 2 ];
+
+    public:
+    [[nodiscard]] static constexpr std::size_t size ( ) noexcept { return N * ( N + 1 ) / 2; }
+
+    // The stored, zero-based, columns [ b, e ) of zero-based row i_ [the lower triangle].
+    [[nodiscard]] static constexpr std::pair<int, int> columns ( int const i_ ) noexcept { return { 0, i_ + 1 }; }
+    [[nodiscard]] static constexpr bool stored ( int, int ) noexcept { return true; }
+    // Mirrored, ( i, j ) and ( j, i ) are the same element.
+    [[nodiscard]] static constexpr std::size_t offset ( int const i_, int const j_ ) noexcept {
+        return j_ <= i_ ? static_cast<std::size_t> ( i_ ) * ( i_ + 1 ) / 2 + j_
+                        : static_cast<std::size_t> ( j_ ) * ( j_ + 1 ) / 2 + i_;
+    }
+
+    MA_PACKED_ELEMENTS
+
+    SymmetricMatrix ( ) noexcept : m_data{ T{} } {}
+    explicit SymmetricMatrix ( uninitialized_t ) noexcept {}
+};
+
+template<typename T, int N, int KL, int KU, int BaseI = 0, int BaseJ = 0, typename = detail::is_valid_multi_array_type<T>>
+class BandedMatrix {
+
+    static_assert ( KL >= 0 and KU >= 0 and KL < N and KU < N );
+
+    T m_data[ N * ( KL + KU + 1 ) ];
+
+    public:
+    static constexpr int lower_bandwidth = KL, upper_bandwidth = KU, width = KL + KU + 1;
+
+    [[nodiscard]] static constexpr std::size_t size ( ) noexcept { return N * width; }
+
+    // The stored, zero-based, columns [ b, e ) of zero-based row i_ [the band, clipped].
+    [[nodiscard]] static constexpr std::pair<int, int> columns ( int const i_ ) noexcept {
+        return { i_ - KL > 0 ? i_ - KL : 0, i_ + KU + 1 < N ? i_ + KU + 1 : N };
+    }
+    [[nodiscard]] static constexpr bool stored ( int const i_, int const j_ ) noexcept {
+        return j_ >= i_ - KL and j_ <= i_ + KU;
+    }
+    [[nodiscard]] static constexpr std::size_t offset ( int const i_, int const j_ ) noexcept {
+        return static_cast<std::size_t> ( i_ ) * width + ( j_ - i_ + KL );
+    }
+
+    MA_PACKED_ELEMENTS
+
+    BandedMatrix ( ) noexcept : m_data{ T{} } {}
+    explicit BandedMatrix ( uninitialized_t ) noexcept {}
+};
+
+namespace detail {
+
+// The sum of a_[ i ] * b_[ i ], i in [ 0, n_ ).
+template<typename T>
+[[nodiscard]] T dot ( T const * a_, T const * b_, int const n_ ) noexcept {
+    int i = 0;
+    T s   = T{ };
+#if defined( __AVX2__ ) && defined( __FMA__ )
+    if constexpr ( std::is_same_v<T, float> ) {
+        __m256 v0 = _mm256_setzero_ps ( ), v1 = _mm256_setzero_ps ( );
+        for ( ; i + 16 <= n_; i += 16 ) {
+            v0 = _mm256_fmadd_ps ( _mm256_loadu_ps ( a_ + i ), _mm256_loadu_ps ( b_ + i ), v0 );
+            v1 = _mm256_fmadd_ps ( _mm256_loadu_ps ( a_ + i + 8 ), _mm256_loadu_ps ( b_ + i + 8 ), v1 );
+        }
+        v0       = _mm256_add_ps ( v0, v1 );
+        __m128 h = _mm_add_ps ( _mm256_castps256_ps128 ( v0 ), _mm256_extractf128_ps ( v0, 1 ) );
+        h        = _mm_add_ps ( h, _mm_movehl_ps ( h, h ) );
+        s        = _mm_cvtss_f32 ( _mm_add_ss ( h, _mm_movehdup_ps ( h ) ) );
+    }
+    else if constexpr ( std::is_same_v<T, double> ) {
+        __m256d v0 = _mm256_setzero_pd ( ), v1 = _mm256_setzero_pd ( );
+        for ( ; i + 8 <= n_; i += 8 ) {
+            v0 = _mm256_fmadd_pd ( _mm256_loadu_pd ( a_ + i ), _mm256_loadu_pd ( b_ + i ), v0 );
+            v1 = _mm256_fmadd_pd ( _mm256_loadu_pd ( a_ + i + 4 ), _mm256_loadu_pd ( b_ + i + 4 ), v1 );
+        }
+        v0        = _mm256_add_pd ( v0, v1 );
+        __m128d h = _mm_add_pd ( _mm256_castpd256_pd128 ( v0 ), _mm256_extractf128_pd ( v0, 1 ) );
+        s         = _mm_cvtsd_f64 ( _mm_add_sd ( h, _mm_unpackhi_pd ( h, h ) ) );
+    }
+#endif
+    for ( ; i < n_; ++i )
+        s += a_[ i ] * b_[ i ];
+    return s;
+}
+
+// y_[ i ] += a_ * x_[ i ], i in [ 0, n_ ) [this vectorizes as is].
+template<typename T>
+void axpy ( T const a_, T const * x_, T * y_, int const n_ ) noexcept {
+    for ( int i = 0; i < n_; ++i )
+        y_[ i ] += a_ * x_[ i ];
+}
+} // namespace detail
+
+// y = A x, x_ and y_ [Vector's, or anything with data ( )] hold N elements, for any of the packed matrices.
+template<typename A, typename X, typename Y>
+void multiply ( A const & a_, X const & x_, Y & y_ ) noexcept {
+    using T           = typename A::value_type;
+    constexpr int n   = std::get<0> ( A::extents ( ) ), bi = std::get<0> ( A::bases ( ) );
+    T const * const x = x_.data ( );
+    T * const y       = y_.data ( );
+    if constexpr ( requires { A::uplo; } or requires { A::width; } ) {
+        for ( int i = 0; i < n; ++i ) {
+            auto const r = a_.row ( i + bi );
+            y[ i ]       = detail::dot ( r.data ( ), x + A::columns ( i ).first, static_cast<int> ( r.size ( ) ) );
+        }
+    }
+    else {
+        // Symmetric, row i of the lower triangle is also column i of the upper one.
+        for ( int i = 0; i < n; ++i )
+            y[ i ] = T{ };
+        for ( int i = 0; i < n; ++i ) {
+            auto const r = a_.row ( i + bi );
+            y[ i ] += detail::dot ( r.data ( ), x, i + 1 );
+            detail::axpy ( x[ i ], r.data ( ), y, i );
+        }
+    }
+}
+
+// Solves T x = b_ in place, for a triangular T.
+template<typename T, int N, triangle Uplo, int BaseI, int BaseJ, typename B>
+void solve ( TriangularMatrix<T, N, Uplo, BaseI, BaseJ> const & t_, B & b_ ) noexcept {
+    T * const b = b_.data ( );
+    if constexpr ( triangle::lower == Uplo ) {
+        for ( int i = 0; i < N; ++i ) {
+            T const * const r = t_.row ( i + BaseI ).data ( );
+            b[ i ]            = ( b[ i ] - detail::dot ( r, b, i ) ) / r[ i ];
+        }
+    }
+    else {
+        for ( int i = N - 1; i >= 0; --i ) {
+            T const * const r = t_.row ( i + BaseI ).data ( ); // Starts at the diagonal.
+            b[ i ]            = ( b[ i ] - detail::dot ( r + 1, b + i + 1, N - 1 - i ) ) / r[ 0 ];
+        }
+    }
+}
+
+// Solves L^T x = b_ in place, for a lower triangular L [the second half of a Cholesky solve].
+template<typename T, int N, int BaseI, int BaseJ, typename B>
+void solve_transposed ( TriangularMatrix<T, N, triangle::lower, BaseI, BaseJ> const & l_, B & b_ ) noexcept {
+    T * const b = b_.data ( );
+    for ( int i = N - 1; i >= 0; --i ) {
+        T const * const r = l_.row ( i + BaseI ).data ( );
+        b[ i ] /= r[ i ];
+        detail::axpy ( -b[ i ], r, b, i ); // Column i of L^T is row i of L.
+    }
+}
+
+// The Cholesky-factorization, A = L L^T, of a symmetric positive definite A, 0 on success, i > 0 if the i-th leading
+//  minor is not positive definite.
+template<typename T, int N, int BaseI, int BaseJ>
+[[nodiscard]] int factor ( SymmetricMatrix<T, N, BaseI, BaseJ> const & a_,
+                           TriangularMatrix<T, N, triangle::lower, BaseI, BaseJ> & l_ ) noexcept {
+    std::memcpy ( l_.data ( ), a_.data ( ), a_.size ( ) * sizeof ( T ) ); // Same (packed lower) layout.
+    for ( int i = 0; i < N; ++i ) {
+        T * const ri = l_.row ( i + BaseI ).data ( );
+        for ( int j = 0; j < i; ++j ) {
+            T const * const rj = l_.row ( j + BaseI ).data ( );
+            ri[ j ]            = ( ri[ j ] - detail::dot ( ri, rj, j ) ) / rj[ j ];
+        }
+        T const d = ri[ i ] - detail::dot ( ri, ri, i );
+        if ( not( d > T{ } ) )
+            return i + 1;
+        ri[ i ] = std::sqrt ( d );
+    }
+    return 0;
+}
+
+// Solves A x = b_ in place, for a symmetric positive definite A, returns as factor ( ).
+template<typename T, int N, int BaseI, int BaseJ, typename B>
+[[nodiscard]] int solve ( SymmetricMatrix<T, N, BaseI, BaseJ> const & a_, B & b_ ) noexcept {
+    TriangularMatrix<T, N, triangle::lower, BaseI, BaseJ> l{ uninitialized };
+    if ( int const info = factor ( a_, l ); info )
+        return info;
+    solve ( l, b_ );
+    solve_transposed ( l, b_ );
+    return 0;
+}
+
+// The LU-factorization, in place and without pivoting [which would widen the band], of a banded A, f.e. a diagonally
+//  dominant one, 0 on success, i > 0 if the i-th pivot is zero.
+template<typename T, int N, int KL, int KU, int BaseI, int BaseJ>
+[[nodiscard]] int factor ( BandedMatrix<T, N, KL, KU, BaseI, BaseJ> & a_ ) noexcept {
+    using A = BandedMatrix<T, N, KL, KU, BaseI, BaseJ>;
+    T * const d = a_.data ( );
+    for ( int k = 0; k < N; ++k ) {
+        T const p = d[ A::offset ( k, k ) ];
+        if ( T{ } == p )
+            return k + 1;
+        int const e = k + KU + 1 < N ? k + KU + 1 : N;
+        for ( int i = k + 1; i <= k + KL and i < N; ++i ) {
+            T const l = d[ A::offset ( i, k ) ] /= p;
+            detail::axpy ( -l, d + A::offset ( k, k + 1 ), d + A::offset ( i, k + 1 ), e - k - 1 );
+        }
+    }
+    return 0;
+}
+
+// Solves A x = b_ in place, given the factorization of a banded A.
+template<typename T, int N, int KL, int KU, int BaseI, int BaseJ, typename B>
+void solve ( BandedMatrix<T, N, KL, KU, BaseI, BaseJ> const & lu_, B & b_ ) noexcept {
+    using A           = BandedMatrix<T, N, KL, KU, BaseI, BaseJ>;
+    T const * const d = lu_.data ( );
+    T * const b       = b_.data ( );
+    for ( int i = 1; i < N; ++i ) { // L, unit diagonal.
+        int const f = A::columns ( i ).first;
+        b[ i ] -= detail::dot ( d + A::offset ( i, f ), b + f, i - f );
+    }
+    for ( int i = N - 1; i >= 0; --i ) { // U.
+        int const e = A::columns ( i ).second;
+        b[ i ]      = ( b[ i ] - detail::dot ( d + A::offset ( i, i + 1 ), b + i + 1, e - i - 1 ) ) / d[ A::offset ( i, i ) ];
+    }
+}
+
+} // namespace sax
+
+#undef MA_PACKED_ASSERT
+#undef MA_PACKED_ELEMENTS
@@ -0,0 +1,99 @@
+
+// MIT License
+//
+// Copyright (c) 2019, 2020 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef> // std::size_t
+
+#include <thread>
+#include <utility> // std::pair
+#include <vector>
+
+// The parallel traversal shared by the parallel algorithms: [ 0, n ) is split into (at most) one contiguous partition
+//  per thread, partition p always covering the same range for the same n and thread count. Memory that is first
+//  touched through parallel_for ( ) [see make_large ( )] therefore lands on the NUMA node of the thread that later
+//  traverses it.
+
+namespace sax {
+
+// The default number of threads, 0 means std::thread::hardware_concurrency ( ).
+inline unsigned default_threads = 0;
+
+namespace detail {
+
+[[nodiscard]] inline unsigned threads ( unsigned const t_ ) noexcept {
+    unsigned const t = t_ ? t_ : default_threads ? default_threads : std::thread::hardware_concurrency ( );
+    return t ? t : 1;
+}
+
+// Partition p_ of parts_ of [ 0, n_ ).
+[[nodiscard]] constexpr std::pair<std::size_t, std::size_t> partition ( std::size_t const n_, unsigned const parts_,
+                                                                        unsigned const p_ ) noexcept {
+    std::size_t const q = n_ / parts_, r = n_ % parts_;
+    std::size_t const b = p_ * q + ( p_ < r ? p_ : r );
+    return { b, b + q + ( p_ < r ) };
+}
+
+// The workers of parallel_for ( ), joined on destruction, also when starting the next one throws [std::system_error].
+struct workers {
+    std::vector<std::thread> threads;
+    ~workers ( ) noexcept {
+        for ( std::thread & t : threads )
+            t.join ( );
+    }
+};
+} // namespace detail
+
+// The number of partitions parallel_for ( ) will use.
+[[nodiscard]] inline unsigned parallel_partitions ( std::size_t const n_, unsigned const threads_ = 0,
+                                                    std::size_t const grain_ = 1 ) noexcept {
+    unsigned t = detail::threads ( threads_ );
+    if ( grain_ > 1 and n_ / grain_ < t )
+        t = static_cast<unsigned> ( n_ / grain_ ) ? static_cast<unsigned> ( n_ / grain_ ) : 1u;
+    if ( t > n_ )
+        t = n_ ? static_cast<unsigned> ( n_ ) : 1u;
+    return t;
+}
+
+// Calls f_ ( p, b, e ) concurrently for all partitions p, [ b, e ), of [ 0, n_ ), on (at most) threads_ threads and
+//  with partitions of at least grain_ elements. The calling thread does partition 0. f_ should not throw [allocate any
+//  scratch up front], parallel_for ( ) itself throws std::system_error if a thread can't be started, after joining the
+//  ones that were.
+template<typename F>
+void parallel_for ( std::size_t const n_, F && f_, unsigned const threads_ = 0, std::size_t const grain_ = 1 ) {
+    unsigned const t = parallel_partitions ( n_, threads_, grain_ );
+    if ( 1 == t ) {
+        f_ ( 0u, std::size_t{ 0 }, n_ );
+        return;
+    }
+    detail::workers w;
+    w.threads.reserve ( t - 1 );
+    for ( unsigned p = 1; p < t; ++p ) {
+        auto const [ b, e ] = detail::partition ( n_, t, p );
+        w.threads.emplace_back ( [ &f_, p, b = b, e = e ] ( ) { f_ ( p, b, e ); } );
+    }
+    auto const [ b, e ] = detail::partition ( n_, t, 0 );
+    f_ ( 0u, b, e );
+}
+
+} // namespace sax
@@ -0,0 +1,323 @@
+
+// MIT License
+//
+// Copyright (c) 2019, 2020 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cassert> // assert
+#include <cmath>   // std::nearbyint
+#include <cstddef> // std::size_t, std::byte
+#include <cstring> // std::memcpy
+
+#include <algorithm> // std::min, std::max
+#include <array>
+#include <memory>
+#include <new> // std::align_val_t, std::launder
+#include <type_traits>
+#include <utility> // std::index_sequence
+#include <vector>
+
+#include "multi_array.hpp"
+#include "multi_array_parallel.hpp"
+
+// Multi-resolution pyramids [mip chains] of any Vector, Matrix, Cube or HyperCube.
+//
+//  downsample<F> ( fine, coarse ) halves every extent [rounding up, the last cell of an odd extent is its own parent],
+//  coarse cell i covers fine cells 2i and 2i + 1, with a box [mean], min, max or Gaussian [binomial 1-3-3-1, over fine
+//  cells 2i - 1 .. 2i + 2] filter. upsample<P> ( coarse, fine ) is the matching prolongation, nearest [copy the parent]
+//  or linear [the cell-centred 3/4, 1/4 interpolation]. Both are separable and fused: for every output slab the input
+//  slabs are combined into one scratch slab [an, in the innermost dimension vectorizable, weighted sum or min / max]
+//  which is resampled recursively in the remaining dimensions, so the scratch stays small and in cache. The output
+//  slabs are split over the threads. Computation is in float [double for double and 32-bit and wider integers],
+//  integers are rounded.
+//
+//  Pyramid<Array, Levels> holds level 0 [an Array] to level Levels - 1, every level a container of the same kind, with
+//  the same bases and the extents halved, all in one contiguous [64-byte aligned per level] allocation. Level L cell c
+//  covers the level 0 cells from base + ( c - base ) * 2^L, coarse<L> ( ) and fine<L> ( ) map the coordinates.
+
+namespace sax {
+
+enum class reduction { box, min, max, gaussian };
+enum class prolongation { nearest, linear };
+
+namespace detail {
+
+// The extent E halved L times, rounding up.
+[[nodiscard]] constexpr int halved ( int const e_, int const l_ ) noexcept { return ( e_ + ( 1 << l_ ) - 1 ) >> l_; }
+
+// The container like Array, with its extents halved L times.
+template<typename Array, int L>
+struct halved_array;
+template<typename T, int I, int BaseI, typename V, int L>
+struct halved_array<Vector<T, I, BaseI, V>, L> {
+    using type = Vector<T, halved ( I, L ), BaseI>;
+};
+template<typename T, int I, int J, int BaseI, int BaseJ, typename V, int L>
+struct halved_array<Matrix<T, I, J, BaseI, BaseJ, V>, L> {
+    using type = Matrix<T, halved ( I, L ), halved ( J, L ), BaseI, BaseJ>;
+};
+template<typename T, int I, int J, int K, int BaseI, int BaseJ, int BaseK, typename V, int L>
+struct halved_array<Cube<T, I, J, K, BaseI, BaseJ, BaseK, V>, L> {
+    using type = Cube<T, halved ( I, L ), halved ( J, L ), halved ( K, L ), BaseI, BaseJ, BaseK>;
+};
+template<typename T, int I, int J, int K, int M, int BaseI, int BaseJ, int BaseK, int BaseM, typename V, int L>
+struct halved_array<HyperCube<T, I, J, K, M, BaseI, BaseJ, BaseK, BaseM, V>, L> {
+    using type = HyperCube<T, halved ( I, L ), halved ( J, L ), halved ( K, L ), halved ( M, L ), BaseI, BaseJ, BaseK, BaseM>;
+};
+
+template<typename Array, int L>
+using halved_array_t = typename halved_array<Array, L>::type;
+
+template<typename T>
+using resample_t = std::conditional_t<std::is_same_v<T, double> or ( std::is_integral_v<T> and sizeof ( T ) >= 4 ), double, float>;
+
+// The input cells, and their weights, of output cell i_, of a dimension with n_ input cells.
+struct stencil {
+    int taps;
+    int at[ 4 ];
+    float weight[ 4 ];
+};
+
+template<reduction F>
+[[nodiscard]] constexpr stencil reduce_stencil ( int const i_, int const n_ ) noexcept {
+    auto const c = [ n_ ] ( int const j_ ) noexcept { return std::min ( std::max ( j_, 0 ), n_ - 1 ); };
+    if constexpr ( reduction::gaussian == F )
+        return { 4, { c ( 2 * i_ - 1 ), c ( 2 * i_ ), c ( 2 * i_ + 1 ), c ( 2 * i_ + 2 ) }, { 0.125f, 0.375f, 0.375f, 0.125f } };
+    else
+        return { 2, { c ( 2 * i_ ), c ( 2 * i_ + 1 ) }, { 0.5f, 0.5f } };
+}
+
+template<prolongation P>
+[[nodiscard]] constexpr stencil expand_stencil ( int const i_, int const n_ ) noexcept {
+    int const k = i_ >> 1;
+    if constexpr ( prolongation::nearest == P )
+        return { 1, { k }, { 1.0f } };
+    else
+        return { 2, { k, i_ & 1 ? std::min ( k + 1, n_ - 1 ) : std::max ( k - 1, 0 ) }, { 0.75f, 0.25f } };
+}
+
+template<typename T, typename A>
+[[nodiscard]] inline T resampled ( A const v_ ) noexcept {
+    if constexpr ( std::is_integral_v<T> )
+        return static_cast<T> ( std::nearbyint ( v_ ) );
+    else
+        return static_cast<T> ( v_ );
+}
+
+// Output slabs [ b_, e_ ) of the first of rank_ dimensions, with extents ein_ [in_] and eout_ [out_], Op is 0 for
+//  the weighted sum, 1 for the min, 2 for the max, st_ ( i, n ) the stencil of output i. The scratch is a slab at every
+//  dimension but the first.
+template<int Op, typename S, typename T, typename A, typename Stencil>
+void resample ( S const * in_, T * out_, int const * ein_, int const * eout_, int const rank_, A * scratch_,
+                Stencil const & st_, int const b_, int const e_ ) noexcept {
+    std::size_t sin = 1, sout = 1;
+    for ( int d = 1; d < rank_; ++d ) {
+        sin *= static_cast<std::size_t> ( ein_[ d ] );
+        sout *= static_cast<std::size_t> ( eout_[ d ] );
+    }
+    for ( int i = b_; i < e_; ++i ) {
+        stencil const s = st_ ( i, ein_[ 0 ] );
+        if ( 1 == rank_ ) {
+            A v = static_cast<A> ( in_[ s.at[ 0 ] ] ) * ( Op ? A ( 1 ) : A ( s.weight[ 0 ] ) );
+            for ( int t = 1; t < s.taps; ++t ) {
+                A const x = static_cast<A> ( in_[ s.at[ t ] ] );
+                v         = 0 == Op ? v + A ( s.weight[ t ] ) * x : 1 == Op ? ( x < v ? x : v ) : ( x > v ? x : v );
+            }
+            out_[ i ] = resampled<T> ( v );
+            continue;
+        }
+        S const * const x = in_ + s.at[ 0 ] * sin;
+        if constexpr ( 0 == Op ) {
+            A const w = A ( s.weight[ 0 ] );
+            for ( std::size_t k = 0; k < sin; ++k )
+                scratch_[ k ] = w * static_cast<A> ( x[ k ] );
+        }
+        else {
+            for ( std::size_t k = 0; k < sin; ++k )
+                scratch_[ k ] = static_cast<A> ( x[ k ] );
+        }
+        for ( int t = 1; t < s.taps; ++t ) {
+            S const * const y = in_ + s.at[ t ] * sin;
+            A const w         = A ( s.weight[ t ] );
+            for ( std::size_t k = 0; k < sin; ++k ) { // These vectorize.
+                A const v = static_cast<A> ( y[ k ] );
+                if constexpr ( 0 == Op )
+                    scratch_[ k ] += w * v;
+                else if constexpr ( 1 == Op )
+                    scratch_[ k ] = v < scratch_[ k ] ? v : scratch_[ k ];
+                else
+                    scratch_[ k ] = v > scratch_[ k ] ? v : scratch_[ k ];
+            }
+        }
+        resample<Op> ( static_cast<A const *> ( scratch_ ), out_ + i * sout, ein_ + 1, eout_ + 1, rank_ - 1, scratch_ + sin, st_, 0,
+                       eout_[ 1 ] );
+    }
+}
+
+template<int Op, typename In, typename Out, typename Stencil>
+void resample ( In const & in_, Out & out_, Stencil const & st_, unsigned const threads_ ) {
+    using l = layout<In>;
+    using A = resample_t<typename Out::value_type>;
+    static_assert ( l::rank == layout<Out>::rank );
+    std::size_t scratch = 0, s = 1;
+    for ( int d = l::rank - 1; d > 0; --d )
+        scratch += s *= static_cast<std::size_t> ( l::extents[ d ] );
+    std::size_t const n = static_cast<std::size_t> ( layout<Out>::extents[ 0 ] );
+    std::vector<A> t ( scratch * parallel_partitions ( n, threads_, 1 ) ); // One scratch per partition.
+    parallel_for (
+        n,
+        [ & ] ( unsigned const p_, std::size_t const b_, std::size_t const e_ ) noexcept {
+            resample<Op> ( in_.data ( ), out_.data ( ), l::extents.data ( ), layout<Out>::extents.data ( ), l::rank,
+                           t.data ( ) + p_ * scratch, st_, static_cast<int> ( b_ ), static_cast<int> ( e_ ) );
+        },
+        threads_, 1 );
+}
+} // namespace detail
+
+// Halves fine_ into coarse_, with filter F, the extents of coarse_ are those of fine_ halved, rounding up.
+template<reduction F = reduction::box, typename Fine, typename Coarse>
+void downsample ( Fine const & fine_, Coarse & coarse_, unsigned const threads_ = 0 ) {
+    using f = detail::layout<Fine>;
+    using c = detail::layout<Coarse>;
+    static_assert ( f::rank == c::rank );
+    for ( int d = 0; d < f::rank; ++d )
+        assert ( c::extents[ d ] == detail::halved ( f::extents[ d ], 1 ) );
+    constexpr int op = reduction::min == F ? 1 : reduction::max == F ? 2 : 0;
+    detail::resample<op> ( fine_, coarse_, detail::reduce_stencil<F>, threads_ );
+}
+
+// Doubles coarse_ into fine_, with prolongation P, the extents of coarse_ are those of fine_ halved, rounding up.
+template<prolongation P = prolongation::linear, typename Coarse, typename Fine>
+void upsample ( Coarse const & coarse_, Fine & fine_, unsigned const threads_ = 0 ) {
+    using f = detail::layout<Fine>;
+    using c = detail::layout<Coarse>;
+    static_assert ( f::rank == c::rank );
+    for ( int d = 0; d < f::rank; ++d )
+        assert ( c::extents[ d ] == detail::halved ( f::extents[ d ], 1 ) );
+    detail::resample<0> ( coarse_, fine_, detail::expand_stencil<P>, threads_ );
+}
+
+template<typename Array, int Levels>
+class Pyramid {
+
+    static_assert ( Levels > 0 );
+
+    using layout = detail::layout<Array>;
+
+    public:
+    template<int L>
+    using level_type       = detail::halved_array_t<Array, L>;
+    using value_type       = typename Array::value_type;
+    using coordinates_type = coordinates_t<Array>;
+
+    static constexpr int levels = Levels;
+
+    private:
+    static constexpr std::size_t alignment = 64;
+
+    // The byte offsets of the levels, and the size of the allocation.
+    static constexpr std::array<std::size_t, Levels + 1> offsets = [] ( ) noexcept {
+        std::array<std::size_t, Levels + 1> o{ };
+        for ( int l = 0; l < Levels; ++l ) {
+            std::size_t n = 1;
+            for ( int d = 0; d < layout::rank; ++d )
+                n *= static_cast<std::size_t> ( detail::halved ( layout::extents[ d ], l ) );
+            o[ l + 1 ] = ( o[ l ] + n * sizeof ( value_type ) + alignment - 1 ) / alignment * alignment;
+        }
+        return o;
+    }( );
+
+    struct deleter {
+        void operator( ) ( std::byte * const p_ ) const noexcept { ::operator delete ( p_, std::align_val_t{ alignment } ); }
+    };
+
+    std::unique_ptr<std::byte, deleter> m_data;
+
+    template<std::size_t... L>
+    void construct ( std::index_sequence<L...> ) noexcept {
+        ( ::new ( m_data.get ( ) + offsets[ L ] ) level_type<L> ( uninitialized ), ... );
+    }
+
+    template<reduction F, std::size_t... L>
+    void reduce ( std::index_sequence<L...>, unsigned const threads_ ) {
+        ( downsample<F> ( level<L> ( ), level<L + 1> ( ), threads_ ), ... );
+    }
+
+    public:
+    Pyramid ( ) : m_data{ static_cast<std::byte *> ( ::operator new ( offsets[ Levels ], std::align_val_t{ alignment } ) ) } {
+        construct ( std::make_index_sequence<Levels>{ } );
+    }
+    // A box pyramid of a_, for another filter, construct empty and build<F> ( a_ ).
+    explicit Pyramid ( Array const & a_, unsigned const threads_ = 0 ) : Pyramid{ } { build ( a_, threads_ ); }
+
+    // Level 0 becomes a_, the other levels are reduced from it.
+    template<reduction F = reduction::box>
+    void build ( Array const & a_, unsigned const threads_ = 0 ) {
+        std::memcpy ( level<0> ( ).data ( ), a_.data ( ), Array::size ( ) * sizeof ( value_type ) );
+        reduce<F> ( threads_ );
+    }
+
+    // Levels 1 .. Levels - 1, level by level from level 0.
+    template<reduction F = reduction::box>
+    void reduce ( unsigned const threads_ = 0 ) {
+        reduce<F> ( std::make_index_sequence<Levels - 1>{ }, threads_ );
+    }
+
+    // Level L - 1 from level L [f.e. to prolong a coarse correction].
+    template<int L, prolongation P = prolongation::linear>
+    void expand ( unsigned const threads_ = 0 ) {
+        static_assert ( L > 0 and L < Levels );
+        upsample<P> ( level<L> ( ), level<L - 1> ( ), threads_ );
+    }
+
+    template<int L>
+    [[nodiscard]] level_type<L> & level ( ) noexcept {
+        static_assert ( L >= 0 and L < Levels );
+        return *std::launder ( reinterpret_cast<level_type<L> *> ( m_data.get ( ) + offsets[ L ] ) );
+    }
+    template<int L>
+    [[nodiscard]] level_type<L> const & level ( ) const noexcept {
+        static_assert ( L >= 0 and L < Levels );
+        return *std::launder ( reinterpret_cast<level_type<L> const *> ( m_data.get ( ) + offsets[ L ] ) );
+    }
+
+    // The coordinates at level L of the cell covering level 0 cell c_, and the first level 0 cell covered by level L
+    //  cell c_.
+    template<int L>
+    [[nodiscard]] static constexpr coordinates_type coarse ( coordinates_type c_ ) noexcept {
+        for ( int d = 0; d < layout::rank; ++d )
+            c_[ d ] = layout::bases[ d ] + ( ( c_[ d ] - layout::bases[ d ] ) >> L );
+        return c_;
+    }
+    template<int L>
+    [[nodiscard]] static constexpr coordinates_type fine ( coordinates_type c_ ) noexcept {
+        for ( int d = 0; d < layout::rank; ++d )
+            c_[ d ] = layout::bases[ d ] + ( ( c_[ d ] - layout::bases[ d ] ) << L );
+        return c_;
+    }
+
+    // The one allocation, all levels.
+    [[nodiscard]] std::byte const * data ( ) const noexcept { return m_data.get ( ); }
+    [[nodiscard]] static constexpr std::size_t size_bytes ( ) noexcept { return offsets[ Levels ]; }
+};
+
+} // namespace sax
@@ -0,0 +1,268 @@
+
+// MIT License
+//
+// Copyright (c) 2019, 2020 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cassert> // assert
+#include <cmath>   // std::nearbyint
+#include <cstddef> // std::size_t
+#include <cstdint> // std::int8_t, std::uint8_t, std::int32_t
+
+#include <algorithm> // std::min, std::max
+#include <limits>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#if defined( __AVX2__ )
+#    include <immintrin.h>
+#endif
+
+#include "multi_array.hpp"
+
+// 8-bit quantized arrays: any container of std::int8_t or std::uint8_t, with a scale and a zero point, per tensor [a
+//  quantization] or per row [a Vector of them], value = scale * ( q - zero_point ).
+//
+//  quantize ( ) picks the parameters from the range of the data [symmetric for int8, zero point 0, asymmetric for
+//  uint8] or takes given ones, quantize_rows ( ) does a Matrix row by row, dequantize ( ) and dequantize_rows ( ) go
+//  back to float. qdot ( ), qgemv ( ) and qgemm ( ) multiply int8 and uint8 data [in any combination] exactly, in int32,
+//  the dequantizing qgemv ( ) applies the scales and zero points to the int32 result. With AVX2, 16 elements at a time
+//  are widened to int16 and multiplied and pair-wise added by madd [maddubs would save the widening, but saturates the
+//  pair sums of uint8 x int8 in int16]. Every kernel takes a bool template parameter Simd, qdot<false> ( ) and friends
+//  are the scalar reference.
+
+namespace sax {
+
+struct quantization {
+    float scale    = 1.0f;
+    int zero_point = 0;
+};
+
+namespace detail {
+
+template<typename T>
+inline constexpr bool is_q8_v = std::is_same_v<std::remove_const_t<T>, std::int8_t> or
+                                std::is_same_v<std::remove_const_t<T>, std::uint8_t>;
+
+template<typename Q>
+[[nodiscard]] inline Q quantize ( float const x_, quantization const & q_ ) noexcept {
+    using limits = std::numeric_limits<Q>;
+    float const v = std::nearbyint ( x_ / q_.scale ) + static_cast<float> ( q_.zero_point );
+    return static_cast<Q> ( std::min ( std::max ( v, float{ limits::min ( ) } ), float{ limits::max ( ) } ) );
+}
+
+[[nodiscard]] inline float dequantize ( int const q_, quantization const & q ) noexcept {
+    return q.scale * static_cast<float> ( q_ - q.zero_point );
+}
+
+// The parameters for Q covering [ lo_, hi_ ].
+template<typename Q>
+[[nodiscard]] inline quantization quantization_of ( float lo_, float hi_ ) noexcept {
+    if constexpr ( std::is_signed_v<Q> ) {
+        float const m = std::max ( -lo_, hi_ );
+        return { m > 0.0f ? m / 127.0f : 1.0f, 0 };
+    }
+    else {
+        lo_ = std::min ( lo_, 0.0f ); // Zero is exact.
+        hi_ = std::max ( hi_, 0.0f );
+        if ( hi_ == lo_ )
+            return { 1.0f, 0 };
+        float const s = ( hi_ - lo_ ) / 255.0f;
+        return { s, std::min ( std::max ( static_cast<int> ( std::nearbyint ( -lo_ / s ) ), 0 ), 255 ) };
+    }
+}
+
+template<typename Q>
+void quantize ( float const * s_, Q * d_, std::size_t const n_, quantization const & q_ ) noexcept {
+    for ( std::size_t i = 0; i < n_; ++i )
+        d_[ i ] = quantize<Q> ( s_[ i ], q_ );
+}
+
+template<typename Q>
+[[nodiscard]] quantization quantize ( float const * s_, Q * d_, std::size_t const n_ ) noexcept {
+    float lo = 0.0f, hi = 0.0f;
+    for ( std::size_t i = 0; i < n_; ++i ) {
+        lo = std::min ( lo, s_[ i ] );
+        hi = std::max ( hi, s_[ i ] );
+    }
+    quantization const q = quantization_of<Q> ( lo, hi );
+    quantize ( s_, d_, n_, q );
+    return q;
+}
+
+#if defined( __AVX2__ )
+template<typename Q>
+[[nodiscard]] inline __m256i widen ( Q const * p_ ) noexcept {
+    __m128i const v = _mm_loadu_si128 ( reinterpret_cast<__m128i const *> ( p_ ) );
+    if constexpr ( std::is_signed_v<Q> )
+        return _mm256_cvtepi8_epi16 ( v );
+    else
+        return _mm256_cvtepu8_epi16 ( v );
+}
+#endif
+
+// The exact int32 dot-product of the n_ elements at a_ and b_.
+template<bool Simd, typename A, typename B>
+[[nodiscard]] std::int32_t dot_q8 ( A const * a_, B const * b_, std::size_t const n_ ) noexcept {
+    std::int32_t s = 0;
+    std::size_t i  = 0;
+#if defined( __AVX2__ )
+    if constexpr ( Simd ) {
+        __m256i x = _mm256_setzero_si256 ( ), y = _mm256_setzero_si256 ( );
+        for ( ; i + 32 <= n_; i += 32 ) {
+            x = _mm256_add_epi32 ( x, _mm256_madd_epi16 ( widen ( a_ + i ), widen ( b_ + i ) ) );
+            y = _mm256_add_epi32 ( y, _mm256_madd_epi16 ( widen ( a_ + i + 16 ), widen ( b_ + i + 16 ) ) );
+        }
+        for ( ; i + 16 <= n_; i += 16 )
+            x = _mm256_add_epi32 ( x, _mm256_madd_epi16 ( widen ( a_ + i ), widen ( b_ + i ) ) );
+        x          = _mm256_add_epi32 ( x, y );
+        __m128i h  = _mm_add_epi32 ( _mm256_castsi256_si128 ( x ), _mm256_extracti128_si256 ( x, 1 ) );
+        h          = _mm_add_epi32 ( h, _mm_shuffle_epi32 ( h, 0x4e ) );
+        h          = _mm_add_epi32 ( h, _mm_shuffle_epi32 ( h, 0xb1 ) );
+        s          = _mm_cvtsi128_si32 ( h );
+    }
+#endif
+    for ( ; i < n_; ++i )
+        s += static_cast<std::int32_t> ( a_[ i ] ) * static_cast<std::int32_t> ( b_[ i ] );
+    return s;
+}
+
+template<typename Q>
+[[nodiscard]] inline std::int32_t sum_q8 ( Q const * p_, std::size_t const n_ ) noexcept {
+    std::int32_t s = 0;
+    for ( std::size_t i = 0; i < n_; ++i ) // This vectorizes as is.
+        s += p_[ i ];
+    return s;
+}
+
+// The parameters of row i_ [zero-based].
+[[nodiscard]] inline quantization const & row_quantization ( quantization const & q_, int ) noexcept { return q_; }
+template<int I, int BaseI>
+[[nodiscard]] inline quantization const & row_quantization ( Vector<quantization, I, BaseI> const & q_, int const i_ ) noexcept {
+    return q_.data ( )[ i_ ];
+}
+} // namespace detail
+
+// Quantizes the floats of src_ into dst_ [int8 or uint8], with parameters covering their range, which are returned.
+template<typename Src, typename Dst>
+quantization quantize ( Src const & src_, Dst & dst_ ) noexcept {
+    auto const s = detail::elements ( src_ );
+    auto const d = detail::elements ( dst_ );
+    static_assert ( std::is_same_v<std::remove_const_t<typename decltype ( s )::element_type>, float> and
+                    detail::is_q8_v<typename decltype ( d )::element_type> );
+    assert ( s.size ( ) == d.size ( ) );
+    return detail::quantize ( s.data ( ), d.data ( ), s.size ( ) );
+}
+
+// As above, with the given parameters.
+template<typename Src, typename Dst>
+void quantize ( Src const & src_, quantization const & q_, Dst & dst_ ) noexcept {
+    auto const s = detail::elements ( src_ );
+    auto const d = detail::elements ( dst_ );
+    static_assert ( std::is_same_v<std::remove_const_t<typename decltype ( s )::element_type>, float> and
+                    detail::is_q8_v<typename decltype ( d )::element_type> );
+    assert ( s.size ( ) == d.size ( ) );
+    detail::quantize ( s.data ( ), d.data ( ), s.size ( ), q_ );
+}
+
+// Quantizes every row of src_ with its own parameters, q_.at ( i ) for row i.
+template<typename Q, int I, int J, int BaseI, int BaseJ>
+void quantize_rows ( Matrix<float, I, J, BaseI, BaseJ> const & src_, Matrix<Q, I, J, BaseI, BaseJ> & dst_,
+                     Vector<quantization, I, BaseI> & q_ ) noexcept {
+    static_assert ( detail::is_q8_v<Q> );
+    for ( int i = 0; i < I; ++i )
+        q_.data ( )[ i ] = detail::quantize ( src_.data ( ) + i * J, dst_.data ( ) + i * J, J );
+}
+
+// The floats of the quantized src_, into dst_.
+template<typename Src, typename Dst>
+void dequantize ( Src const & src_, quantization const & q_, Dst & dst_ ) noexcept {
+    auto const s = detail::elements ( src_ );
+    auto const d = detail::elements ( dst_ );
+    static_assert ( detail::is_q8_v<typename decltype ( s )::element_type> and
+                    std::is_same_v<typename decltype ( d )::element_type, float> );
+    assert ( s.size ( ) == d.size ( ) );
+    for ( std::size_t i = 0; i < s.size ( ); ++i )
+        d[ i ] = detail::dequantize ( s[ i ], q_ );
+}
+
+template<typename Q, int I, int J, int BaseI, int BaseJ>
+void dequantize_rows ( Matrix<Q, I, J, BaseI, BaseJ> const & src_, Vector<quantization, I, BaseI> const & q_,
+                       Matrix<float, I, J, BaseI, BaseJ> & dst_ ) noexcept {
+    static_assert ( detail::is_q8_v<Q> );
+    for ( int i = 0; i < I; ++i )
+        for ( int j = 0; j < J; ++j )
+            dst_.data ( )[ i * J + j ] = detail::dequantize ( src_.data ( )[ i * J + j ], q_.data ( )[ i ] );
+}
+
+// The exact dot-product of the int8 or uint8 elements of a_ and b_.
+template<bool Simd = true, typename A, typename B>
+[[nodiscard]] std::int32_t qdot ( A const & a_, B const & b_ ) noexcept {
+    auto const a = detail::elements ( a_ );
+    auto const b = detail::elements ( b_ );
+    static_assert ( detail::is_q8_v<typename decltype ( a )::element_type> and
+                    detail::is_q8_v<typename decltype ( b )::element_type> );
+    assert ( a.size ( ) == b.size ( ) );
+    return detail::dot_q8<Simd> ( a.data ( ), b.data ( ), a.size ( ) );
+}
+
+// y_ = w_ x_, exactly, in int32.
+template<bool Simd = true, typename W, typename X, int I, int J, int BaseI, int BaseJ>
+void qgemv ( Matrix<W, I, J, BaseI, BaseJ> const & w_, Vector<X, J, BaseJ> const & x_,
+             Vector<std::int32_t, I, BaseI> & y_ ) noexcept {
+    static_assert ( detail::is_q8_v<W> and detail::is_q8_v<X> );
+    for ( int i = 0; i < I; ++i )
+        y_.data ( )[ i ] = detail::dot_q8<Simd> ( w_.data ( ) + i * J, x_.data ( ), J );
+}
+
+// y_ = w_ x_, dequantized, wq_ is a quantization [per tensor] or a Vector<quantization, I, BaseI> [per row].
+template<bool Simd = true, typename W, typename Scales, typename X, int I, int J, int BaseI, int BaseJ>
+void qgemv ( Matrix<W, I, J, BaseI, BaseJ> const & w_, Scales const & wq_, Vector<X, J, BaseJ> const & x_,
+             quantization const & xq_, Vector<float, I, BaseI> & y_ ) noexcept {
+    static_assert ( detail::is_q8_v<W> and detail::is_q8_v<X> );
+    // sum ( ( w - zw ) ( x - zx ) ) = sum ( w x ) - zx sum ( w ) - zw sum ( x ) + J zw zx.
+    std::int32_t const sx = detail::sum_q8 ( x_.data ( ), J );
+    for ( int i = 0; i < I; ++i ) {
+        W const * const w      = w_.data ( ) + i * J;
+        quantization const & q = detail::row_quantization ( wq_, i );
+        std::int32_t const s   = detail::dot_q8<Simd> ( w, x_.data ( ), J ) - xq_.zero_point * detail::sum_q8 ( w, J ) -
+                               q.zero_point * sx + J * q.zero_point * xq_.zero_point;
+        y_.data ( )[ i ] = q.scale * xq_.scale * static_cast<float> ( s );
+    }
+}
+
+// c_ = a_ b_, exactly, in int32, for small matrices [b_ is transposed once, to take the dot-products of rows].
+template<bool Simd = true, typename A, typename B, int I, int K, int J, int BaseI, int BaseK, int BaseJ>
+void qgemm ( Matrix<A, I, K, BaseI, BaseK> const & a_, Matrix<B, K, J, BaseK, BaseJ> const & b_,
+             Matrix<std::int32_t, I, J, BaseI, BaseJ> & c_ ) {
+    static_assert ( detail::is_q8_v<A> and detail::is_q8_v<B> );
+    std::vector<B> t ( static_cast<std::size_t> ( J ) * K );
+    for ( int k = 0; k < K; ++k )
+        for ( int j = 0; j < J; ++j )
+            t[ j * K + k ] = b_.data ( )[ k * J + j ];
+    for ( int i = 0; i < I; ++i )
+        for ( int j = 0; j < J; ++j )
+            c_.data ( )[ i * J + j ] = detail::dot_q8<Simd> ( a_.data ( ) + i * K, t.data ( ) + j * K, K );
+}
+
+} // namespace sax
@@ -0,0 +1,165 @@
+
+// MIT License
+//
+// Copyright (c) 2019, 2020 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cassert> // assert
+#include <cstddef> // std::size_t
+#include <cstring> // std::memcpy
+
+#include <span>
+#include <type_traits>
+#include <utility> // std::index_sequence
+
+#include "multi_array.hpp"
+
+// Periodic (toroidal) indexing and ring-buffered arrays.
+//
+//  wrap_at ( a, i, j, ... ) is a.at ( i, j, ... ) with every index wrapped into [ Base, Base + Extent ), without an
+//  integer division: a mask for power-of-two extents, otherwise a compare-and-subtract for indices that are less than
+//  one period out of range [the common case of neighbour stencils], only further out it falls back to the modulo.
+//
+//  Ring<Array> is an Array of which the first dimension is circular: a sliding window of the last extent rows [or
+//  planes, ...]. push ( ) drops the oldest slab and appends a new one, in O(slab), the other slabs do not move, only the
+//  (physical) origin of the window advances. at ( i, ... ) takes base-adjusted, logical, indices, i == Base is the oldest
+//  slab, i == Base + Extent - 1 the newest.
+
+namespace sax {
+
+namespace detail {
+
+// Zero-based i_ - Base_, wrapped into [ 0, Extent_ ).
+template<int Extent_, int Base_>
+[[nodiscard]] constexpr int wrap ( int const i_ ) noexcept {
+    int r = i_ - Base_;
+    if constexpr ( 0 == ( Extent_ & ( Extent_ - 1 ) ) ) {
+        return r & ( Extent_ - 1 ); // Also for negative r, in two's complement.
+    }
+    else {
+        if ( r < -Extent_ or r >= 2 * Extent_ ) [[unlikely]]
+            return ( r % Extent_ + Extent_ ) % Extent_;
+        r -= Extent_ & -static_cast<int> ( r >= Extent_ );
+        r += Extent_ & -static_cast<int> ( r < 0 );
+        return r;
+    }
+}
+
+template<typename Array, std::size_t... R, typename... Indices>
+[[nodiscard]] constexpr int wrapped_offset ( std::index_sequence<R...>, Indices const... i_ ) noexcept {
+    using l = layout<Array>;
+    return ( ( wrap<l::extents[ R ], l::bases[ R ]> ( i_ ) * l::strides[ R ] ) + ... );
+}
+} // namespace detail
+
+// The index i_ of dimension R of Array, wrapped into [ Base, Base + Extent ).
+template<typename Array, int R = 0>
+[[nodiscard]] constexpr int wrap_index ( int const i_ ) noexcept {
+    using l = detail::layout<Array>;
+    return detail::wrap<l::extents[ R ], l::bases[ R ]> ( i_ ) + l::bases[ R ];
+}
+
+// The element at i_..., every index wrapped into its range, periodic boundaries.
+template<typename Array, typename... Indices>
+[[nodiscard]] constexpr decltype ( auto ) wrap_at ( Array & a_, Indices const... i_ ) noexcept {
+    static_assert ( sizeof...( Indices ) == detail::layout<std::remove_const_t<Array>>::rank );
+    return a_.data ( )[ detail::wrapped_offset<std::remove_const_t<Array>> ( std::index_sequence_for<Indices...>{ }, i_... ) ];
+}
+
+template<typename Array>
+class Ring {
+
+    using layout = detail::layout<Array>;
+
+    public:
+    using value_type       = typename Array::value_type;
+    using reference        = value_type &;
+    using size_type        = std::size_t;
+    using extents_type     = typename Array::extents_type;
+    using coordinates_type = coordinates_t<Array>;
+
+    static constexpr int slabs          = layout::extents[ 0 ];
+    static constexpr std::size_t stride = static_cast<std::size_t> ( layout::strides[ 0 ] ); // The elements in a slab.
+
+    [[nodiscard]] static constexpr std::size_t size ( ) noexcept { return Array::size ( ); }
+    [[nodiscard]] static constexpr extents_type extents ( ) noexcept { return Array::extents ( ); }
+    [[nodiscard]] static constexpr extents_type bases ( ) noexcept { return Array::bases ( ); }
+
+    private:
+    Array m_array;
+    int m_head = 0; // The physical (zero-based) slab of the oldest, logical, slab.
+
+    // The physical slab of the (base-adjusted) logical slab i_, head + i is at most one period out.
+    [[nodiscard]] int physical ( int const i_ ) const noexcept {
+        assert ( i_ >= layout::bases[ 0 ] and i_ < slabs + layout::bases[ 0 ] );
+        int const p = m_head + i_ - layout::bases[ 0 ];
+        return p - ( slabs & -static_cast<int> ( p >= slabs ) );
+    }
+
+    public:
+    Ring ( ) noexcept = default;
+    explicit Ring ( Array const & a_ ) noexcept : m_array{ a_ } {}
+
+    // The elements of the (base-adjusted) logical slab i_.
+    [[nodiscard]] std::span<value_type, stride> slab ( int const i_ ) noexcept {
+        return std::span<value_type, stride>{ m_array.data ( ) + physical ( i_ ) * stride, stride };
+    }
+    [[nodiscard]] std::span<value_type const, stride> slab ( int const i_ ) const noexcept {
+        return std::span<value_type const, stride>{ m_array.data ( ) + physical ( i_ ) * stride, stride };
+    }
+
+    template<typename... Indices>
+    [[nodiscard]] reference at ( int const i_, Indices const... r_ ) noexcept {
+        static_assert ( sizeof...( Indices ) + 1 == layout::rank );
+        return m_array.data ( )[ layout::offset ( { physical ( i_ ) + layout::bases[ 0 ], r_... } ) ];
+    }
+    template<typename... Indices>
+    [[nodiscard]] value_type at ( int const i_, Indices const... r_ ) const noexcept {
+        static_assert ( sizeof...( Indices ) + 1 == layout::rank );
+        return m_array.data ( )[ layout::offset ( { physical ( i_ ) + layout::bases[ 0 ], r_... } ) ];
+    }
+
+    // Drops the oldest slab, the (stale) storage becomes the newest slab, which is returned, to be filled in place.
+    [[nodiscard]] std::span<value_type, stride> advance ( ) noexcept {
+        value_type * const s = m_array.data ( ) + m_head * stride;
+        m_head += 1 - ( slabs & -static_cast<int> ( m_head + 1 == slabs ) );
+        return std::span<value_type, stride>{ s, stride };
+    }
+
+    // Drops the oldest slab and appends s_ as the newest.
+    void push ( std::span<value_type const, stride> const s_ ) noexcept {
+        std::memcpy ( advance ( ).data ( ), s_.data ( ), stride * sizeof ( value_type ) );
+    }
+
+    // The window, in logical order [oldest first], in (at most) two copies.
+    void linearize ( Array & a_ ) const noexcept {
+        std::size_t const h = static_cast<std::size_t> ( m_head ) * stride;
+        std::memcpy ( a_.data ( ), m_array.data ( ) + h, ( size ( ) - h ) * sizeof ( value_type ) );
+        std::memcpy ( a_.data ( ) + ( size ( ) - h ), m_array.data ( ), h * sizeof ( value_type ) );
+    }
+
+    // The physical storage and the physical slab of the oldest logical slab.
+    [[nodiscard]] Array const & array ( ) const noexcept { return m_array; }
+    [[nodiscard]] int head ( ) const noexcept { return m_head; }
+};
+
+} // namespace sax
@@ -0,0 +1,246 @@
+
+// MIT License
+//
+// Copyright (c) 2019, 2020 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cassert> // assert
+#include <cmath>   // std::floor
+#include <cstddef> // std::size_t
+
+#include <array>
+#include <span>
+#include <type_traits>
+#include <utility> // std::index_sequence
+
+#if defined( __AVX2__ )
+#    include <immintrin.h>
+#endif
+
+#include "multi_array.hpp"
+#include "multi_array_ring.hpp"
+
+// Batched sampling of a (floating point) Array at fractional, base-adjusted, coordinates, given as one span of
+//  coordinates per dimension (SoA, as in gather ( )). The element at index i sits at coordinate i, so sampling at
+//  integer coordinates returns the elements themselves. The filters are nearest [the closest element], linear
+//  [bilinear for a Matrix, trilinear for a Cube, ...] and cubic [Catmull-Rom, separable, 4^rank elements]. The edge
+//  policy applies to the elements the filter reaches outside the Array: clamp [to the nearest edge element], wrap
+//  [periodic] or zero.
+//
+//  For float Array's [of any rank], 8 samples are done at once, with AVX2 gathers and FMA, everything else [and the
+//  remainder] is scalar. The coordinates should be finite, and less than 2^24 out of range.
+
+namespace sax {
+
+enum class filter { nearest, linear, cubic };
+enum class edge { clamp, wrap, zero };
+
+template<typename Array>
+using sample_coordinates_t = std::array<std::span<float const>, detail::layout<Array>::rank>;
+
+namespace detail {
+
+[[nodiscard]] constexpr int power ( int const b_, int const e_ ) noexcept { return e_ ? b_ * power ( b_, e_ - 1 ) : 1; }
+
+template<filter F>
+inline constexpr int taps_v = filter::nearest == F ? 1 : filter::linear == F ? 2 : 4;
+
+// The first tap and the weights of the taps at (zero-based) coordinate x_.
+template<filter F>
+[[nodiscard]] inline int weights ( float const x_, float * w_ ) noexcept {
+    if constexpr ( filter::nearest == F ) {
+        w_[ 0 ] = 1.0f;
+        return static_cast<int> ( std::floor ( x_ + 0.5f ) );
+    }
+    else {
+        float const f = std::floor ( x_ ), t = x_ - f;
+        if constexpr ( filter::linear == F ) {
+            w_[ 0 ] = 1.0f - t;
+            w_[ 1 ] = t;
+            return static_cast<int> ( f );
+        }
+        else {
+            w_[ 0 ] = 0.5f * ( ( ( 2.0f - t ) * t - 1.0f ) * t );
+            w_[ 1 ] = 0.5f * ( ( 3.0f * t - 5.0f ) * t * t + 2.0f );
+            w_[ 2 ] = 0.5f * ( ( ( 4.0f - 3.0f * t ) * t + 1.0f ) * t );
+            w_[ 3 ] = 0.5f * ( ( t - 1.0f ) * t * t );
+            return static_cast<int> ( f ) - 1;
+        }
+    }
+}
+
+// The (zero-based) index i_ after the edge policy, false if it refers to a zero outside.
+template<edge E, int Extent>
+[[nodiscard]] inline bool apply_edge ( int & i_ ) noexcept {
+    if constexpr ( edge::clamp == E )
+        i_ = i_ < 0 ? 0 : i_ >= Extent ? Extent - 1 : i_;
+    else if constexpr ( edge::wrap == E )
+        i_ = wrap<Extent, 0> ( i_ );
+    else
+        return i_ >= 0 and i_ < Extent;
+    return true;
+}
+
+template<filter F, edge E, typename Array>
+[[nodiscard]] typename Array::value_type sample ( Array const & a_, sample_coordinates_t<Array> const & c_,
+                                                  std::size_t const n_ ) noexcept {
+    using l            = layout<Array>;
+    constexpr int taps = taps_v<F>;
+    int o[ l::rank ][ taps ]; // Offsets, i.e. index times stride.
+    float w[ l::rank ][ taps ];
+    bool v[ l::rank ][ taps ];
+    [ & ]<std::size_t... R> ( std::index_sequence<R...> ) noexcept {
+        (
+            [ & ] ( ) noexcept {
+                int const f = weights<F> ( c_[ R ][ n_ ] - static_cast<float> ( l::bases[ R ] ), w[ R ] );
+                for ( int k = 0; k < taps; ++k ) {
+                    int i       = f + k;
+                    v[ R ][ k ] = apply_edge<E, l::extents[ R ]> ( i );
+                    o[ R ][ k ] = i * l::strides[ R ];
+                }
+            }( ),
+            ... );
+    }( std::make_index_sequence<l::rank>{ } );
+    using T = typename Array::value_type;
+    T s     = T{ };
+    for ( int t = 0; t < detail::power ( taps, l::rank ); ++t ) {
+        int x = 0, q = t;
+        T y   = T{ 1 };
+        bool b = true;
+        for ( int r = l::rank - 1; r >= 0; --r, q /= taps ) {
+            x += o[ r ][ q % taps ];
+            y *= static_cast<T> ( w[ r ][ q % taps ] );
+            b = b and v[ r ][ q % taps ];
+        }
+        if ( b )
+            s += y * a_.data ( )[ x ];
+    }
+    return s;
+}
+
+#if defined( __AVX2__ ) && defined( __FMA__ )
+
+// 8 samples, n_ to n_ + 8, of a float Array.
+template<filter F, edge E, typename Array>
+[[nodiscard]] inline __m256 sample8 ( Array const & a_, sample_coordinates_t<Array> const & c_, std::size_t const n_ ) noexcept {
+    using l            = layout<Array>;
+    constexpr int taps = taps_v<F>;
+    __m256i o[ l::rank ][ taps ];
+    __m256 w[ l::rank ][ taps ];
+    __m256i v[ l::rank ][ taps ]; // All ones, for the elements inside.
+    [ & ]<std::size_t... R> ( std::index_sequence<R...> ) noexcept {
+        (
+            [ & ] ( ) noexcept {
+                constexpr int e = l::extents[ R ];
+                __m256 const x  = _mm256_sub_ps ( _mm256_loadu_ps ( c_[ R ].data ( ) + n_ ),
+                                                 _mm256_set1_ps ( static_cast<float> ( l::bases[ R ] ) ) );
+                __m256i f;
+                if constexpr ( filter::nearest == F ) {
+                    f         = _mm256_cvttps_epi32 ( _mm256_floor_ps ( _mm256_add_ps ( x, _mm256_set1_ps ( 0.5f ) ) ) );
+                    w[ R ][ 0 ] = _mm256_set1_ps ( 1.0f );
+                }
+                else {
+                    __m256 const g = _mm256_floor_ps ( x ), t = _mm256_sub_ps ( x, g ), one = _mm256_set1_ps ( 1.0f );
+                    f              = _mm256_cvttps_epi32 ( g );
+                    if constexpr ( filter::linear == F ) {
+                        w[ R ][ 0 ] = _mm256_sub_ps ( one, t );
+                        w[ R ][ 1 ] = t;
+                    }
+                    else {
+                        __m256 const h = _mm256_set1_ps ( 0.5f ), tt = _mm256_mul_ps ( t, t ), c2 = _mm256_set1_ps ( 2.0f ),
+                                     c3 = _mm256_set1_ps ( 3.0f ), c4 = _mm256_set1_ps ( 4.0f ), c5 = _mm256_set1_ps ( 5.0f );
+                        f = _mm256_sub_epi32 ( f, _mm256_set1_epi32 ( 1 ) );
+                        // As the scalar weights ( ).
+                        w[ R ][ 0 ] = _mm256_mul_ps ( h, _mm256_mul_ps ( _mm256_fmsub_ps ( _mm256_sub_ps ( c2, t ), t, one ), t ) );
+                        w[ R ][ 1 ] = _mm256_mul_ps ( h, _mm256_fmadd_ps ( _mm256_fmsub_ps ( c3, t, c5 ), tt, c2 ) );
+                        w[ R ][ 2 ] =
+                            _mm256_mul_ps ( h, _mm256_mul_ps ( _mm256_fmadd_ps ( _mm256_fnmadd_ps ( c3, t, c4 ), t, one ), t ) );
+                        w[ R ][ 3 ] = _mm256_mul_ps ( h, _mm256_mul_ps ( _mm256_sub_ps ( t, one ), tt ) );
+                    }
+                }
+                __m256i const ev = _mm256_set1_epi32 ( e ), zero = _mm256_setzero_si256 ( );
+                for ( int k = 0; k < taps; ++k ) {
+                    __m256i i = _mm256_add_epi32 ( f, _mm256_set1_epi32 ( k ) );
+                    if constexpr ( edge::wrap == E ) {
+                        if constexpr ( 0 == ( e & ( e - 1 ) ) ) {
+                            i = _mm256_and_si256 ( i, _mm256_set1_epi32 ( e - 1 ) );
+                        }
+                        else {
+                            __m256i const q = _mm256_cvttps_epi32 (
+                                _mm256_floor_ps ( _mm256_mul_ps ( _mm256_cvtepi32_ps ( i ), _mm256_set1_ps ( 1.0f / e ) ) ) );
+                            i = _mm256_sub_epi32 ( i, _mm256_mullo_epi32 ( q, ev ) );
+                            // Off by one period, at most, from the rounding of 1 / e.
+                            i = _mm256_add_epi32 ( i, _mm256_and_si256 ( ev, _mm256_cmpgt_epi32 ( zero, i ) ) );
+                            i = _mm256_sub_epi32 ( i, _mm256_andnot_si256 ( _mm256_cmpgt_epi32 ( ev, i ), ev ) );
+                        }
+                        v[ R ][ k ] = _mm256_set1_epi32 ( -1 );
+                    }
+                    else {
+                        __m256i const c = _mm256_max_epi32 ( zero, _mm256_min_epi32 ( i, _mm256_set1_epi32 ( e - 1 ) ) );
+                        v[ R ][ k ]     = edge::zero == E ? _mm256_cmpeq_epi32 ( c, i ) : _mm256_set1_epi32 ( -1 );
+                        i               = c;
+                    }
+                    o[ R ][ k ] = _mm256_mullo_epi32 ( i, _mm256_set1_epi32 ( l::strides[ R ] ) );
+                }
+            }( ),
+            ... );
+    }( std::make_index_sequence<l::rank>{ } );
+    __m256 s = _mm256_setzero_ps ( );
+    for ( int t = 0; t < detail::power ( taps, l::rank ); ++t ) {
+        __m256i x = _mm256_setzero_si256 ( ), b = _mm256_set1_epi32 ( -1 );
+        __m256 y  = _mm256_set1_ps ( 1.0f );
+        int q     = t;
+        for ( int r = l::rank - 1; r >= 0; --r, q /= taps ) {
+            x = _mm256_add_epi32 ( x, o[ r ][ q % taps ] );
+            y = _mm256_mul_ps ( y, w[ r ][ q % taps ] );
+            if constexpr ( edge::zero == E )
+                b = _mm256_and_si256 ( b, v[ r ][ q % taps ] );
+        }
+        __m256 const g = edge::zero == E ? _mm256_mask_i32gather_ps ( _mm256_setzero_ps ( ), a_.data ( ), x,
+                                                                      _mm256_castsi256_ps ( b ), sizeof ( float ) )
+                                         : _mm256_i32gather_ps ( a_.data ( ), x, sizeof ( float ) );
+        s = _mm256_fmadd_ps ( g, y, s );
+    }
+    return s;
+}
+
+#endif
+} // namespace detail
+
+// out_[ n ] is a_ sampled at ( c_[ 0 ][ n ], c_[ 1 ][ n ], ... ), with filter F and edge policy E.
+template<filter F, edge E = edge::clamp, typename Array>
+void sample ( Array const & a_, sample_coordinates_t<Array> const & c_, std::span<typename Array::value_type> out_ ) noexcept {
+    static_assert ( std::is_floating_point_v<typename Array::value_type> );
+    std::size_t const n = out_.size ( );
+    for ( auto const & s : c_ )
+        assert ( s.size ( ) == n );
+    std::size_t i = 0;
+#if defined( __AVX2__ ) && defined( __FMA__ )
+    if constexpr ( std::is_same_v<typename Array::value_type, float> )
+        for ( ; i + 8 <= n; i += 8 )
+            _mm256_storeu_ps ( out_.data ( ) + i, detail::sample8<F, E> ( a_, c_, i ) );
+#endif
+    for ( ; i < n; ++i )
+        out_[ i ] = detail::sample<F, E> ( a_, c_, i );
+}
+
+} // namespace sax
@@ -0,0 +1,483 @@
+
+// MIT License
+//
+// Copyright (c) 2019, 2020 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef> // std::size_t
+#include <cstdint> // std::int8_t, ...
+
+#include <algorithm> // std::min
+#include <array>
+#include <atomic>
+#include <bit> // std::countr_zero, std::popcount
+#include <limits>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#if defined( __AVX2__ )
+#    include <immintrin.h>
+#endif
+
+#include "multi_array.hpp"
+#include "multi_array_parallel.hpp"
+
+// Searching the elements of any container [or view]: find ( ), find_if ( ), count ( ), count_if ( ), any ( ), all ( ),
+//  argmin ( ) and argmax ( ). Positions come back as base-adjusted coordinates [position_t, the coordinates_t of the
+//  container, a zero-based index into a std::span].
+//
+//  The simple predicates, value compare_op v [equal, less, ...], are evaluated 32 bytes at a time with AVX2 into a bit
+//  mask, one bit per byte, so the first hit is the countr_zero and a count the popcount, divided by the element size.
+//  find ( ) exits at the first 128 byte block with a hit. Large arrays are searched in parallel, in chunks, a thread
+//  stops at the first chunk past a hit that was already found. argmin ( ) and argmax ( ) reduce to the extreme value
+//  first and then find its first occurrence, NaNs are never the minimum or the maximum.
+
+namespace sax {
+
+enum class compare { equal, not_equal, less, less_equal, greater, greater_equal };
+
+namespace detail {
+
+template<typename X>
+struct position_type {
+    using type = std::array<int, 1>;
+};
+template<typename X>
+requires requires { typename X::extents_type; }
+struct position_type<X> {
+    using type = coordinates_t<X>;
+};
+} // namespace detail
+
+// The position of an element, base-adjusted coordinates, or for a std::span, the index.
+template<typename X>
+using position_t = typename detail::position_type<std::remove_const_t<X>>::type;
+
+namespace detail {
+
+inline constexpr std::size_t search_grain = std::size_t{ 1 } << 16, search_chunk = std::size_t{ 1 } << 13;
+
+template<typename X>
+[[nodiscard]] constexpr position_t<X> position ( std::size_t const o_ ) noexcept {
+    if constexpr ( requires { typename X::extents_type; } )
+        return layout<std::remove_const_t<X>>::coordinates ( static_cast<int> ( o_ ) );
+    else
+        return { static_cast<int> ( o_ ) };
+}
+
+[[nodiscard]] constexpr compare negation ( compare const c_ ) noexcept {
+    switch ( c_ ) {
+        case compare::equal: return compare::not_equal;
+        case compare::not_equal: return compare::equal;
+        case compare::less: return compare::greater_equal;
+        case compare::less_equal: return compare::greater;
+        case compare::greater: return compare::less_equal;
+        default: return compare::less;
+    }
+}
+
+// Whether x_ compares C to v_ [Negated, whether it doesn't, which holds for a NaN, unlike the negation ( C )].
+template<compare C, bool Negated = false, typename T>
+[[nodiscard]] constexpr bool holds ( T const x_, T const v_ ) noexcept {
+    if constexpr ( compare::equal == C )
+        return Negated != ( x_ == v_ );
+    else if constexpr ( compare::not_equal == C )
+        return Negated != ( x_ != v_ );
+    else if constexpr ( compare::less == C )
+        return Negated != ( x_ < v_ );
+    else if constexpr ( compare::less_equal == C )
+        return Negated != ( x_ <= v_ );
+    else if constexpr ( compare::greater == C )
+        return Negated != ( x_ > v_ );
+    else
+        return Negated != ( x_ >= v_ );
+}
+
+#if defined( __AVX2__ )
+
+// The AVX2 operations on the elements of type T, of all (arithmetic) types but long double.
+template<typename T, typename = void>
+struct lanes {
+    static constexpr bool simd = false;
+};
+
+template<>
+struct lanes<float> {
+    static constexpr bool simd = true, minmax = true;
+    using vector               = __m256;
+    [[nodiscard]] static vector load ( float const * p_ ) noexcept { return _mm256_loadu_ps ( p_ ); }
+    [[nodiscard]] static vector broadcast ( float const v_ ) noexcept { return _mm256_set1_ps ( v_ ); }
+    [[nodiscard]] static vector min ( vector const a_, vector const b_ ) noexcept { return _mm256_min_ps ( a_, b_ ); }
+    [[nodiscard]] static vector max ( vector const a_, vector const b_ ) noexcept { return _mm256_max_ps ( a_, b_ ); }
+    template<compare C, bool Negated = false>
+    [[nodiscard]] static __m256i test ( vector const x_, vector const v_ ) noexcept {
+        constexpr int p = compare::equal == C        ? ( Negated ? _CMP_NEQ_UQ : _CMP_EQ_OQ )
+                          : compare::not_equal == C  ? ( Negated ? _CMP_EQ_OQ : _CMP_NEQ_UQ )
+                          : compare::less == C       ? ( Negated ? _CMP_NLT_UQ : _CMP_LT_OQ )
+                          : compare::less_equal == C ? ( Negated ? _CMP_NLE_UQ : _CMP_LE_OQ )
+                          : compare::greater == C    ? ( Negated ? _CMP_NGT_UQ : _CMP_GT_OQ )
+                                                     : ( Negated ? _CMP_NGE_UQ : _CMP_GE_OQ );
+        return _mm256_castps_si256 ( _mm256_cmp_ps ( x_, v_, p ) );
+    }
+    template<int H>
+    [[nodiscard]] static float reduce ( vector v_ ) noexcept {
+        alignas ( 32 ) float a[ 8 ];
+        _mm256_store_ps ( a, v_ );
+        float r = a[ 0 ];
+        for ( int i = 1; i < 8; ++i )
+            r = H ? ( a[ i ] > r ? a[ i ] : r ) : ( a[ i ] < r ? a[ i ] : r );
+        return r;
+    }
+};
+
+template<>
+struct lanes<double> {
+    static constexpr bool simd = true, minmax = true;
+    using vector               = __m256d;
+    [[nodiscard]] static vector load ( double const * p_ ) noexcept { return _mm256_loadu_pd ( p_ ); }
+    [[nodiscard]] static vector broadcast ( double const v_ ) noexcept { return _mm256_set1_pd ( v_ ); }
+    [[nodiscard]] static vector min ( vector const a_, vector const b_ ) noexcept { return _mm256_min_pd ( a_, b_ ); }
+    [[nodiscard]] static vector max ( vector const a_, vector const b_ ) noexcept { return _mm256_max_pd ( a_, b_ ); }
+    template<compare C, bool Negated = false>
+    [[nodiscard]] static __m256i test ( vector const x_, vector const v_ ) noexcept {
+        constexpr int p = compare::equal == C        ? ( Negated ? _CMP_NEQ_UQ : _CMP_EQ_OQ )
+                          : compare::not_equal == C  ? ( Negated ? _CMP_EQ_OQ : _CMP_NEQ_UQ )
+                          : compare::less == C       ? ( Negated ? _CMP_NLT_UQ : _CMP_LT_OQ )
+                          : compare::less_equal == C ? ( Negated ? _CMP_NLE_UQ : _CMP_LE_OQ )
+                          : compare::greater == C    ? ( Negated ? _CMP_NGT_UQ : _CMP_GT_OQ )
+                                                     : ( Negated ? _CMP_NGE_UQ : _CMP_GE_OQ );
+        return _mm256_castpd_si256 ( _mm256_cmp_pd ( x_, v_, p ) );
+    }
+    template<int H>
+    [[nodiscard]] static double reduce ( vector v_ ) noexcept {
+        alignas ( 32 ) double a[ 4 ];
+        _mm256_store_pd ( a, v_ );
+        double r = a[ 0 ];
+        for ( int i = 1; i < 4; ++i )
+            r = H ? ( a[ i ] > r ? a[ i ] : r ) : ( a[ i ] < r ? a[ i ] : r );
+        return r;
+    }
+};
+
+// The integers, unsigned ones compare signed after flipping the sign bit.
+template<typename T>
+struct lanes<T, std::enable_if_t<std::is_integral_v<T> and not std::is_same_v<T, bool>>> {
+    static constexpr bool simd = true, minmax = sizeof ( T ) < 8;
+    using vector               = __m256i;
+    [[nodiscard]] static vector load ( T const * p_ ) noexcept {
+        return _mm256_loadu_si256 ( reinterpret_cast<__m256i const *> ( p_ ) );
+    }
+    [[nodiscard]] static vector broadcast ( T const v_ ) noexcept {
+        if constexpr ( 1 == sizeof ( T ) )
+            return _mm256_set1_epi8 ( static_cast<char> ( v_ ) );
+        else if constexpr ( 2 == sizeof ( T ) )
+            return _mm256_set1_epi16 ( static_cast<short> ( v_ ) );
+        else if constexpr ( 4 == sizeof ( T ) )
+            return _mm256_set1_epi32 ( static_cast<int> ( v_ ) );
+        else
+            return _mm256_set1_epi64x ( static_cast<long long> ( v_ ) );
+    }
+    [[nodiscard]] static vector eq ( vector const a_, vector const b_ ) noexcept {
+        if constexpr ( 1 == sizeof ( T ) )
+            return _mm256_cmpeq_epi8 ( a_, b_ );
+        else if constexpr ( 2 == sizeof ( T ) )
+            return _mm256_cmpeq_epi16 ( a_, b_ );
+        else if constexpr ( 4 == sizeof ( T ) )
+            return _mm256_cmpeq_epi32 ( a_, b_ );
+        else
+            return _mm256_cmpeq_epi64 ( a_, b_ );
+    }
+    [[nodiscard]] static vector gt ( vector a_, vector b_ ) noexcept {
+        if constexpr ( std::is_unsigned_v<T> ) {
+            vector const s = broadcast ( static_cast<T> ( T{ 1 } << ( 8 * sizeof ( T ) - 1 ) ) );
+            a_             = _mm256_xor_si256 ( a_, s );
+            b_             = _mm256_xor_si256 ( b_, s );
+        }
+        if constexpr ( 1 == sizeof ( T ) )
+            return _mm256_cmpgt_epi8 ( a_, b_ );
+        else if constexpr ( 2 == sizeof ( T ) )
+            return _mm256_cmpgt_epi16 ( a_, b_ );
+        else if constexpr ( 4 == sizeof ( T ) )
+            return _mm256_cmpgt_epi32 ( a_, b_ );
+        else
+            return _mm256_cmpgt_epi64 ( a_, b_ );
+    }
+    [[nodiscard]] static vector min ( vector const a_, vector const b_ ) noexcept {
+        if constexpr ( 1 == sizeof ( T ) )
+            return std::is_signed_v<T> ? _mm256_min_epi8 ( a_, b_ ) : _mm256_min_epu8 ( a_, b_ );
+        else if constexpr ( 2 == sizeof ( T ) )
+            return std::is_signed_v<T> ? _mm256_min_epi16 ( a_, b_ ) : _mm256_min_epu16 ( a_, b_ );
+        else
+            return std::is_signed_v<T> ? _mm256_min_epi32 ( a_, b_ ) : _mm256_min_epu32 ( a_, b_ );
+    }
+    [[nodiscard]] static vector max ( vector const a_, vector const b_ ) noexcept {
+        if constexpr ( 1 == sizeof ( T ) )
+            return std::is_signed_v<T> ? _mm256_max_epi8 ( a_, b_ ) : _mm256_max_epu8 ( a_, b_ );
+        else if constexpr ( 2 == sizeof ( T ) )
+            return std::is_signed_v<T> ? _mm256_max_epi16 ( a_, b_ ) : _mm256_max_epu16 ( a_, b_ );
+        else
+            return std::is_signed_v<T> ? _mm256_max_epi32 ( a_, b_ ) : _mm256_max_epu32 ( a_, b_ );
+    }
+    template<compare C, bool Negated = false>
+    [[nodiscard]] static __m256i test ( vector const x_, vector const v_ ) noexcept {
+        vector const ones = _mm256_set1_epi8 ( -1 );
+        if constexpr ( Negated )
+            return test<negation ( C )> ( x_, v_ ); // No NaNs.
+        else if constexpr ( compare::equal == C )
+            return eq ( x_, v_ );
+        else if constexpr ( compare::not_equal == C )
+            return _mm256_xor_si256 ( eq ( x_, v_ ), ones );
+        else if constexpr ( compare::less == C )
+            return gt ( v_, x_ );
+        else if constexpr ( compare::less_equal == C )
+            return _mm256_xor_si256 ( gt ( x_, v_ ), ones );
+        else if constexpr ( compare::greater == C )
+            return gt ( x_, v_ );
+        else
+            return _mm256_xor_si256 ( gt ( v_, x_ ), ones );
+    }
+    template<int H>
+    [[nodiscard]] static T reduce ( vector v_ ) noexcept {
+        alignas ( 32 ) T a[ 32 / sizeof ( T ) ];
+        _mm256_store_si256 ( reinterpret_cast<__m256i *> ( a ), v_ );
+        T r = a[ 0 ];
+        for ( std::size_t i = 1; i < 32 / sizeof ( T ); ++i )
+            r = H ? ( a[ i ] > r ? a[ i ] : r ) : ( a[ i ] < r ? a[ i ] : r );
+        return r;
+    }
+};
+
+template<typename T>
+inline constexpr bool simd_search_v = lanes<T>::simd;
+#else
+template<typename T>
+inline constexpr bool simd_search_v = false;
+#endif
+
+// The index of the first of the n_ elements at p_ that compares C to v_ [Negated, that doesn't], or n_.
+template<compare C, bool Negated = false, typename T>
+[[nodiscard]] std::size_t first ( T const * const p_, std::size_t const n_, T const v_ ) noexcept {
+    std::size_t i = 0;
+#if defined( __AVX2__ )
+    if constexpr ( simd_search_v<T> ) {
+        using l                = lanes<T>;
+        constexpr std::size_t w = 32 / sizeof ( T );
+        auto const v           = l::broadcast ( v_ );
+        for ( ; i + 4 * w <= n_; i += 4 * w ) {
+            __m256i const a = l::template test<C, Negated> ( l::load ( p_ + i ), v );
+            __m256i const b = l::template test<C, Negated> ( l::load ( p_ + i + w ), v );
+            __m256i const c = l::template test<C, Negated> ( l::load ( p_ + i + 2 * w ), v );
+            __m256i const d = l::template test<C, Negated> ( l::load ( p_ + i + 3 * w ), v );
+            __m256i const o = _mm256_or_si256 ( _mm256_or_si256 ( a, b ), _mm256_or_si256 ( c, d ) );
+            if ( _mm256_testz_si256 ( o, o ) )
+                continue;
+            std::uint64_t const lo = static_cast<std::uint32_t> ( _mm256_movemask_epi8 ( a ) ) |
+                                     static_cast<std::uint64_t> ( static_cast<std::uint32_t> ( _mm256_movemask_epi8 ( b ) ) ) << 32;
+            if ( lo )
+                return i + static_cast<std::size_t> ( std::countr_zero ( lo ) ) / sizeof ( T );
+            std::uint64_t const hi = static_cast<std::uint32_t> ( _mm256_movemask_epi8 ( c ) ) |
+                                     static_cast<std::uint64_t> ( static_cast<std::uint32_t> ( _mm256_movemask_epi8 ( d ) ) ) << 32;
+            return i + 2 * w + static_cast<std::size_t> ( std::countr_zero ( hi ) ) / sizeof ( T );
+        }
+    }
+#endif
+    for ( ; i < n_; ++i )
+        if ( holds<C, Negated> ( p_[ i ], v_ ) )
+            return i;
+    return n_;
+}
+
+// The number of the n_ elements at p_ that compare C to v_.
+template<compare C, typename T>
+[[nodiscard]] std::size_t tally ( T const * const p_, std::size_t const n_, T const v_ ) noexcept {
+    std::size_t i = 0, c = 0;
+#if defined( __AVX2__ )
+    if constexpr ( simd_search_v<T> ) {
+        using l                = lanes<T>;
+        constexpr std::size_t w = 32 / sizeof ( T );
+        auto const v           = l::broadcast ( v_ );
+        std::size_t bits       = 0;
+        for ( ; i + w <= n_; i += w ) {
+            __m256i const t = l::template test<C> ( l::load ( p_ + i ), v );
+            bits += static_cast<std::size_t> ( std::popcount ( static_cast<std::uint32_t> ( _mm256_movemask_epi8 ( t ) ) ) );
+        }
+        c = bits / sizeof ( T );
+    }
+#endif
+    for ( ; i < n_; ++i )
+        c += holds<C> ( p_[ i ], v_ );
+    return c;
+}
+
+// The minimum [H == 0] or maximum [H == 1] of the n_ elements at p_, skipping NaNs, a NaN if there are only NaNs. The
+//  first non-NaN element seeds the reduction, not every T has a numeric_limits identity [f.e. half, bfloat16].
+template<int H, typename T>
+[[nodiscard]] T extremum ( T const * const p_, std::size_t const n_ ) noexcept {
+    std::size_t i = 0;
+    while ( i < n_ and p_[ i ] != p_[ i ] )
+        ++i;
+    if ( i == n_ )
+        return n_ ? p_[ 0 ] : T{ };
+    T r = p_[ i++ ];
+#if defined( __AVX2__ )
+    if constexpr ( simd_search_v<T> ) {
+        if constexpr ( lanes<T>::minmax ) {
+            using l                = lanes<T>;
+            constexpr std::size_t w = 32 / sizeof ( T );
+            auto a = l::broadcast ( r ), b = a;
+            for ( ; i + 2 * w <= n_; i += 2 * w ) { // The accumulator second, the result for a NaN.
+                a = H ? l::max ( l::load ( p_ + i ), a ) : l::min ( l::load ( p_ + i ), a );
+                b = H ? l::max ( l::load ( p_ + i + w ), b ) : l::min ( l::load ( p_ + i + w ), b );
+            }
+            r = l::template reduce<H> ( H ? l::max ( a, b ) : l::min ( a, b ) );
+        }
+    }
+#endif
+    for ( ; i < n_; ++i )
+        r = H ? ( p_[ i ] > r ? p_[ i ] : r ) : ( p_[ i ] < r ? p_[ i ] : r );
+    return r;
+}
+
+// first ( ), over all elements of s_, in parallel.
+template<compare C, bool Negated = false, typename T>
+[[nodiscard]] std::size_t find_first ( std::span<T const> const s_, T const v_, unsigned const threads_ ) {
+    std::atomic<std::size_t> found{ s_.size ( ) };
+    parallel_for (
+        s_.size ( ),
+        [ & ] ( unsigned, std::size_t const b_, std::size_t const e_ ) noexcept {
+            for ( std::size_t b = b_; b < e_; b += search_chunk ) {
+                if ( found.load ( std::memory_order_relaxed ) < b )
+                    return; // There's an earlier one.
+                std::size_t const n = std::min ( search_chunk, e_ - b ), i = b + first<C, Negated> ( s_.data ( ) + b, n, v_ );
+                if ( i < b + n ) {
+                    std::size_t f = found.load ( std::memory_order_relaxed );
+                    while ( i < f and not found.compare_exchange_weak ( f, i, std::memory_order_relaxed ) )
+                        ;
+                    return;
+                }
+            }
+        },
+        threads_, search_grain );
+    return found.load ( std::memory_order_relaxed );
+}
+
+template<compare C, typename T>
+[[nodiscard]] std::size_t count ( std::span<T const> const s_, T const v_, unsigned const threads_ ) {
+    std::vector<std::size_t> c ( parallel_partitions ( s_.size ( ), threads_, search_grain ) );
+    parallel_for (
+        s_.size ( ),
+        [ & ] ( unsigned const p_, std::size_t const b_, std::size_t const e_ ) noexcept {
+            c[ p_ ] = tally<C> ( s_.data ( ) + b_, e_ - b_, v_ );
+        },
+        threads_, search_grain );
+    std::size_t n = 0;
+    for ( std::size_t const p : c )
+        n += p;
+    return n;
+}
+
+// The index of the first minimum [H == 0] or maximum [H == 1] of s_ [0 if all are NaN].
+template<int H, typename T>
+[[nodiscard]] std::size_t arg_extremum ( std::span<T const> const s_, unsigned const threads_ ) {
+    std::vector<T> x ( parallel_partitions ( s_.size ( ), threads_, search_grain ) );
+    parallel_for (
+        s_.size ( ),
+        [ & ] ( unsigned const p_, std::size_t const b_, std::size_t const e_ ) noexcept {
+            x[ p_ ] = extremum<H> ( s_.data ( ) + b_, e_ - b_ );
+        },
+        threads_, search_grain );
+    T const r = extremum<H> ( x.data ( ), x.size ( ) );
+    std::size_t const i = find_first<compare::equal> ( s_, r, threads_ );
+    return i < s_.size ( ) ? i : 0;
+}
+} // namespace detail
+
+// The position of the first element that compares C to v_ [f.e. find_if<compare::greater> ( a, 0 )], if any.
+template<compare C, typename X, typename V>
+[[nodiscard]] std::optional<position_t<X>> find_if ( X const & x_, V const v_, unsigned const threads_ = 0 ) {
+    auto const s        = detail::elements ( x_ );
+    using T             = std::remove_const_t<typename decltype ( s )::element_type>;
+    std::size_t const i = detail::find_first<C> ( std::span<T const>{ s }, static_cast<T> ( v_ ), threads_ );
+    if ( i == s.size ( ) )
+        return std::nullopt;
+    return detail::position<X> ( i );
+}
+
+// The position of the first element equal to v_, if any.
+template<typename X, typename V>
+[[nodiscard]] std::optional<position_t<X>> find ( X const & x_, V const v_, unsigned const threads_ = 0 ) {
+    return find_if<compare::equal> ( x_, v_, threads_ );
+}
+
+// The position of the first element for which p_ ( element ) holds, if any [any predicate, serial and scalar].
+template<typename X, typename Predicate>
+[[nodiscard]] std::optional<position_t<X>> find_if ( X const & x_, Predicate const & p_ ) {
+    auto const s = detail::elements ( x_ );
+    for ( std::size_t i = 0; i < s.size ( ); ++i )
+        if ( p_ ( s[ i ] ) )
+            return detail::position<X> ( i );
+    return std::nullopt;
+}
+
+// The number of elements that compare C to v_.
+template<compare C, typename X, typename V>
+[[nodiscard]] std::size_t count_if ( X const & x_, V const v_, unsigned const threads_ = 0 ) {
+    auto const s = detail::elements ( x_ );
+    using T      = std::remove_const_t<typename decltype ( s )::element_type>;
+    return detail::count<C> ( std::span<T const>{ s }, static_cast<T> ( v_ ), threads_ );
+}
+
+// The number of elements equal to v_.
+template<typename X, typename V>
+[[nodiscard]] std::size_t count ( X const & x_, V const v_, unsigned const threads_ = 0 ) {
+    return count_if<compare::equal> ( x_, v_, threads_ );
+}
+
+// Whether any [all] of the elements compare C to v_ [a NaN compares not_equal, and nothing else].
+template<compare C, typename X, typename V>
+[[nodiscard]] bool any ( X const & x_, V const v_, unsigned const threads_ = 0 ) {
+    return find_if<C> ( x_, v_, threads_ ).has_value ( );
+}
+template<compare C, typename X, typename V>
+[[nodiscard]] bool all ( X const & x_, V const v_, unsigned const threads_ = 0 ) {
+    auto const s = detail::elements ( x_ );
+    using T      = std::remove_const_t<typename decltype ( s )::element_type>;
+    return s.size ( ) == detail::find_first<C, true> ( std::span<T const>{ s }, static_cast<T> ( v_ ), threads_ );
+}
+
+// The position of the first minimum [maximum], NaNs excluded.
+template<typename X>
+[[nodiscard]] position_t<X> argmin ( X const & x_, unsigned const threads_ = 0 ) {
+    auto const s = detail::elements ( x_ );
+    using T      = std::remove_const_t<typename decltype ( s )::element_type>;
+    return detail::position<X> ( detail::arg_extremum<0> ( std::span<T const>{ s }, threads_ ) );
+}
+template<typename X>
+[[nodiscard]] position_t<X> argmax ( X const & x_, unsigned const threads_ = 0 ) {
+    auto const s = detail::elements ( x_ );
+    using T      = std::remove_const_t<typename decltype ( s )::element_type>;
+    return detail::position<X> ( detail::arg_extremum<1> ( std::span<T const>{ s }, threads_ ) );
+}
+
+} // namespace sax
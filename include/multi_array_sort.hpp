@@ -0,0 +1,364 @@
+
+// MIT License
+//
+// Copyright (c) 2019, 2020 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cassert> // assert
+#include <cstddef> // std::size_t
+#include <cstring> // std::memcpy
+
+#include <algorithm> // std::sort, std::stable_sort, std::partial_sort
+#include <array>
+#include <numeric> // std::iota
+#include <type_traits>
+#include <utility> // std::pair
+#include <vector>
+
+#if defined( __AVX2__ )
+#    include <immintrin.h>
+#endif
+
+#include "multi_array.hpp"
+#include "multi_array_parallel.hpp"
+
+// Sorting the slabs [of the first dimension, the rows of a Matrix, the planes of a Cube] of an array, every slab
+//  independently, the slabs split over the threads.
+//
+//  sort_slabs ( ) sorts the elements of every slab. Slabs of up to 32 elements go through a sorting network [Batcher's
+//  odd-even merge sort, generated at compile time for the slab size], applied to 8 slabs at once [AVX2 min / max on
+//  the element of 8 slabs, float, double, (u)int32; otherwise lane-wise]. Integer slabs of over 64 elements are radix
+//  sorted [LSD, a byte at a time, skipping the bytes all keys share], the others go to std::sort.
+//
+//  argsort_slabs ( ) writes, for every slab, the positions of its elements in sorted order, stable, into an array of
+//  the same extents and bases, of slab_index_t [the base-adjusted column of a Matrix, the base-adjusted [ j, k ] of a
+//  Cube]. partial_sort_slabs ( ) sorts the first k elements of every slab, top_k ( ) writes the K largest [smallest]
+//  elements of every slab, and their positions, into the K columns of a Matrix. Slabs should not contain NaNs.
+
+namespace sax {
+
+enum class order { ascending, descending };
+
+// The position of an element in its slab.
+template<typename Array>
+using slab_index_t = std::conditional_t<2 == detail::layout<Array>::rank, int, std::array<int, detail::layout<Array>::rank - 1>>;
+
+namespace detail {
+
+template<typename Array>
+struct slabs {
+    using layout = detail::layout<Array>;
+    static_assert ( layout::rank > 1 );
+    static constexpr int count = layout::extents[ 0 ], size = layout::strides[ 0 ];
+
+    // The base-adjusted position of element o_ of a slab.
+    [[nodiscard]] static constexpr slab_index_t<Array> index ( int const o_ ) noexcept {
+        if constexpr ( 2 == layout::rank ) {
+            return o_ + layout::bases[ 1 ];
+        }
+        else {
+            auto const c = layout::coordinates ( o_ );
+            slab_index_t<Array> i;
+            for ( int r = 1; r < layout::rank; ++r )
+                i[ r - 1 ] = c[ r ];
+            return i;
+        }
+    }
+};
+
+template<order O, typename T>
+[[nodiscard]] constexpr bool before ( T const a_, T const b_ ) noexcept {
+    return order::ascending == O ? a_ < b_ : b_ < a_;
+}
+
+// The comparators of Batcher's odd-even merge sort of N elements [of the network for the next power of two, those
+//  with a missing element compare to infinity and drop out].
+template<int N>
+inline constexpr auto network = [] ( ) noexcept {
+    constexpr auto generate = [] ( auto const & f_ ) noexcept {
+        int p2 = 1;
+        while ( p2 < N )
+            p2 <<= 1;
+        for ( int p = 1; p < p2; p <<= 1 )
+            for ( int k = p; k >= 1; k >>= 1 )
+                for ( int j = k % p; j + k < p2; j += 2 * k )
+                    for ( int i = 0; i < k and i + j + k < p2; ++i )
+                        if ( ( i + j ) / ( 2 * p ) == ( i + j + k ) / ( 2 * p ) and i + j + k < N )
+                            f_ ( i + j, i + j + k );
+    };
+    constexpr int count = [ generate ] ( ) noexcept {
+        int c = 0;
+        generate ( [ &c ] ( int, int ) noexcept { ++c; } );
+        return c;
+    }( );
+    std::array<std::pair<int, int>, count> c{ };
+    int n = 0;
+    generate ( [ & ] ( int const a_, int const b_ ) noexcept { c[ n++ ] = { a_, b_ }; } );
+    return c;
+}( );
+
+inline constexpr int network_limit = 32, radix_threshold = 64;
+
+// Compare-exchange of the W lanes of rows a_ and b_.
+template<order O, typename T, int W>
+inline void exchange ( T * const a_, T * const b_ ) noexcept {
+#if defined( __AVX2__ )
+    if constexpr ( std::is_same_v<T, float> ) {
+        __m256 const a = _mm256_loadu_ps ( a_ ), b = _mm256_loadu_ps ( b_ );
+        _mm256_storeu_ps ( a_, order::ascending == O ? _mm256_min_ps ( a, b ) : _mm256_max_ps ( a, b ) );
+        _mm256_storeu_ps ( b_, order::ascending == O ? _mm256_max_ps ( a, b ) : _mm256_min_ps ( a, b ) );
+        return;
+    }
+    else if constexpr ( std::is_same_v<T, double> ) {
+        for ( int l = 0; l < W; l += 4 ) {
+            __m256d const a = _mm256_loadu_pd ( a_ + l ), b = _mm256_loadu_pd ( b_ + l );
+            _mm256_storeu_pd ( a_ + l, order::ascending == O ? _mm256_min_pd ( a, b ) : _mm256_max_pd ( a, b ) );
+            _mm256_storeu_pd ( b_ + l, order::ascending == O ? _mm256_max_pd ( a, b ) : _mm256_min_pd ( a, b ) );
+        }
+        return;
+    }
+    else if constexpr ( std::is_integral_v<T> and 4 == sizeof ( T ) ) {
+        __m256i const a = _mm256_loadu_si256 ( reinterpret_cast<__m256i const *> ( a_ ) );
+        __m256i const b = _mm256_loadu_si256 ( reinterpret_cast<__m256i const *> ( b_ ) );
+        __m256i const l = std::is_signed_v<T> ? _mm256_min_epi32 ( a, b ) : _mm256_min_epu32 ( a, b );
+        __m256i const h = std::is_signed_v<T> ? _mm256_max_epi32 ( a, b ) : _mm256_max_epu32 ( a, b );
+        _mm256_storeu_si256 ( reinterpret_cast<__m256i *> ( a_ ), order::ascending == O ? l : h );
+        _mm256_storeu_si256 ( reinterpret_cast<__m256i *> ( b_ ), order::ascending == O ? h : l );
+        return;
+    }
+#endif
+    for ( int l = 0; l < W; ++l ) {
+        T const a = a_[ l ], b = b_[ l ];
+        bool const s = before<O> ( b, a );
+        a_[ l ]      = s ? b : a;
+        b_[ l ]      = s ? a : b;
+    }
+}
+
+// Sorts the N elements of the slabs [ b_, e_ ) at p_, W slabs at a time, transposed, element i of the slabs in row i.
+template<order O, int N, typename T>
+void network_sort ( T * const p_, int const b_, int const e_ ) noexcept {
+    constexpr int W = 8;
+    T x[ N ][ W ];
+    for ( int s = b_; s < e_; s += W ) {
+        int const w = std::min ( W, e_ - s );
+        for ( int l = 0; l < W; ++l ) // Short, the last slab pads the lanes.
+            for ( int i = 0; i < N; ++i )
+                x[ i ][ l ] = p_[ ( s + std::min ( l, w - 1 ) ) * N + i ];
+        for ( auto const & [ a, b ] : network<N> )
+            exchange<O, T, W> ( x[ a ], x[ b ] );
+        for ( int l = 0; l < w; ++l )
+            for ( int i = 0; i < N; ++i )
+                p_[ ( s + l ) * N + i ] = x[ i ][ l ];
+    }
+}
+
+// The key of integer v_, unsigned and in the order O.
+template<order O, typename T>
+[[nodiscard]] constexpr std::make_unsigned_t<T> radix_key ( T const v_ ) noexcept {
+    using U = std::make_unsigned_t<T>;
+    U k     = static_cast<U> ( v_ );
+    if constexpr ( std::is_signed_v<T> )
+        k ^= U ( U{ 1 } << ( 8 * sizeof ( T ) - 1 ) );
+    return order::ascending == O ? k : U ( ~k );
+}
+
+// The integer of key k_, the inverse of radix_key ( ).
+template<order O, typename T>
+[[nodiscard]] constexpr T radix_value ( std::make_unsigned_t<T> k_ ) noexcept {
+    using U = std::make_unsigned_t<T>;
+    if constexpr ( order::descending == O )
+        k_ = U ( ~k_ );
+    if constexpr ( std::is_signed_v<T> )
+        k_ ^= U ( U{ 1 } << ( 8 * sizeof ( T ) - 1 ) );
+    return static_cast<T> ( k_ );
+}
+
+// Stable LSD radix sort of the n_ keys at k_, with their payloads at p_ [if not nullptr], t_ and q_ are scratch, returns
+//  where the sorted keys and payloads ended up [k_ and p_, or t_ and q_].
+template<typename U, typename P>
+std::pair<U *, P *> radix_sort ( U * k_, P * p_, std::size_t const n_, U * t_, P * q_ ) noexcept {
+    for ( std::size_t d = 0; d < sizeof ( U ); ++d ) {
+        std::size_t c[ 256 ] = { };
+        int const shift      = static_cast<int> ( 8 * d );
+        for ( std::size_t i = 0; i < n_; ++i )
+            ++c[ ( k_[ i ] >> shift ) & 0xff ];
+        if ( c[ ( k_[ 0 ] >> shift ) & 0xff ] == n_ )
+            continue; // All keys share this byte.
+        std::size_t s = 0;
+        for ( std::size_t & b : c ) {
+            std::size_t const n = b;
+            b                   = s;
+            s += n;
+        }
+        for ( std::size_t i = 0; i < n_; ++i ) {
+            std::size_t const j = c[ ( k_[ i ] >> shift ) & 0xff ]++;
+            t_[ j ]             = k_[ i ];
+            if ( p_ )
+                q_[ j ] = p_[ i ];
+        }
+        std::swap ( k_, t_ );
+        std::swap ( p_, q_ );
+    }
+    return { k_, p_ };
+}
+
+// Whether argsort ( ) of n_ elements of type T radix sorts, it then needs 2 n_ keys and n_ ints of scratch.
+template<typename T>
+[[nodiscard]] constexpr bool radix_argsort ( int const n_ ) noexcept {
+    return std::is_integral_v<T> and n_ > radix_threshold;
+}
+
+// The positions [zero-based] of the n_ elements at v_ in sorted order, stable, into i_, k_ and t_ are the scratch [if
+//  radix_argsort<T> ( n_ )].
+template<order O, typename T, typename U>
+void argsort ( T const * const v_, int * const i_, int const n_, U * const k_, int * const t_ ) noexcept {
+    std::iota ( i_, i_ + n_, 0 );
+    if constexpr ( std::is_integral_v<T> ) {
+        if ( radix_argsort<T> ( n_ ) ) {
+            for ( int i = 0; i < n_; ++i )
+                k_[ i ] = radix_key<O> ( v_[ i ] );
+            auto const r = radix_sort<U, int> ( k_, i_, static_cast<std::size_t> ( n_ ), k_ + n_, t_ );
+            if ( r.second != i_ )
+                std::memcpy ( i_, r.second, static_cast<std::size_t> ( n_ ) * sizeof ( int ) );
+            return;
+        }
+    }
+    std::stable_sort ( i_, i_ + n_, [ v_ ] ( int const a_, int const b_ ) noexcept { return before<O> ( v_[ a_ ], v_[ b_ ] ); } );
+}
+
+// The radix keys of T, a dummy for the others.
+template<typename T>
+using radix_key_t = std::make_unsigned_t<std::conditional_t<std::is_integral_v<T>, T, unsigned>>;
+} // namespace detail
+
+// Sorts every slab of a_.
+template<order O = order::ascending, typename Array>
+void sort_slabs ( Array & a_, unsigned const threads_ = 0 ) {
+    using s = detail::slabs<Array>;
+    using T = typename Array::value_type;
+    using U = detail::radix_key_t<T>;
+    constexpr bool radix = std::is_integral_v<T> and s::size > detail::network_limit and s::size > detail::radix_threshold;
+    T * const p          = a_.data ( );
+    // The radix keys, 2 slabs per partition.
+    std::vector<U> keys ( radix ? 2 * s::size * parallel_partitions ( s::count, threads_, 1 ) : 0 );
+    parallel_for (
+        s::count,
+        [ & ] ( unsigned const p_, std::size_t const b_, std::size_t const e_ ) noexcept {
+            int const b = static_cast<int> ( b_ ), e = static_cast<int> ( e_ );
+            if constexpr ( s::size <= detail::network_limit ) {
+                detail::network_sort<O, s::size> ( p, b, e );
+            }
+            else if constexpr ( radix ) {
+                U * const k = keys.data ( ) + 2 * s::size * p_;
+                for ( int i = b; i < e; ++i ) {
+                    T * const v = p + i * s::size;
+                    for ( int j = 0; j < s::size; ++j )
+                        k[ j ] = detail::radix_key<O> ( v[ j ] );
+                    U const * const r = detail::radix_sort<U, int> ( k, nullptr, s::size, k + s::size, nullptr ).first;
+                    for ( int j = 0; j < s::size; ++j )
+                        v[ j ] = detail::radix_value<O, T> ( r[ j ] );
+                }
+            }
+            else {
+                for ( int i = b; i < e; ++i )
+                    std::sort ( p + i * s::size, p + ( i + 1 ) * s::size,
+                                [] ( T const a_, T const b_ ) noexcept { return detail::before<O> ( a_, b_ ); } );
+            }
+        },
+        threads_, 1 );
+}
+
+// The base-adjusted positions of the elements of every slab of a_, in sorted order, stable, into the same slab of i_.
+template<order O = order::ascending, typename Array, typename Indices>
+void argsort_slabs ( Array const & a_, Indices & i_, unsigned const threads_ = 0 ) {
+    using s = detail::slabs<Array>;
+    using T = typename Array::value_type;
+    static_assert ( std::is_same_v<typename Indices::value_type, slab_index_t<Array>> and
+                    detail::layout<Indices>::extents == detail::layout<Array>::extents and
+                    detail::layout<Indices>::bases == detail::layout<Array>::bases );
+    constexpr bool radix = detail::radix_argsort<T> ( s::size );
+    unsigned const parts = parallel_partitions ( s::count, threads_, 1 );
+    // Per partition, the positions of a slab and, for a radix sort, the keys and the positions scratch.
+    std::vector<detail::radix_key_t<T>> keys ( radix ? 2 * s::size * parts : 0 );
+    std::vector<int> positions ( ( radix ? 2 : 1 ) * s::size * parts );
+    parallel_for (
+        s::count,
+        [ & ] ( unsigned const p_, std::size_t const b_, std::size_t const e_ ) noexcept {
+            int * const o  = positions.data ( ) + ( radix ? 2 : 1 ) * s::size * p_;
+            auto * const k = radix ? keys.data ( ) + 2 * s::size * p_ : nullptr;
+            for ( int i = static_cast<int> ( b_ ); i < static_cast<int> ( e_ ); ++i ) {
+                detail::argsort<O> ( a_.data ( ) + i * s::size, o, s::size, k, o + s::size );
+                for ( int j = 0; j < s::size; ++j )
+                    i_.data ( )[ i * s::size + j ] = s::index ( o[ j ] );
+            }
+        },
+        threads_, 1 );
+}
+
+// Sorts the first k_ elements of every slab of a_, the order of the others is unspecified.
+template<order O = order::ascending, typename Array>
+void partial_sort_slabs ( Array & a_, int const k_, unsigned const threads_ = 0 ) {
+    using s = detail::slabs<Array>;
+    using T = typename Array::value_type;
+    assert ( k_ >= 0 and k_ <= s::size );
+    T * const p = a_.data ( );
+    parallel_for (
+        s::count,
+        [ & ] ( unsigned, std::size_t const b_, std::size_t const e_ ) noexcept {
+            for ( int i = static_cast<int> ( b_ ); i < static_cast<int> ( e_ ); ++i )
+                std::partial_sort ( p + i * s::size, p + i * s::size + k_, p + ( i + 1 ) * s::size,
+                                    [] ( T const a_, T const b_ ) noexcept { return detail::before<O> ( a_, b_ ); } );
+        },
+        threads_, 1 );
+}
+
+// The K largest [order::descending, the default] or smallest elements of every slab of a_, in that order [ties in the
+//  order of their positions], in the row of values_ of the slab, their base-adjusted positions in the row of
+//  indices_.
+template<order O = order::descending, typename Array, typename T, typename I, int N, int K, int BaseN, int BaseK>
+void top_k ( Array const & a_, Matrix<T, N, K, BaseN, BaseK> & values_, Matrix<I, N, K, BaseN, BaseK> & indices_,
+             unsigned const threads_ = 0 ) {
+    using s = detail::slabs<Array>;
+    using V = typename Array::value_type;
+    static_assert ( N == s::count and K <= s::size and std::is_same_v<I, slab_index_t<Array>> );
+    std::vector<int> positions ( s::size * parallel_partitions ( s::count, threads_, 1 ) ); // A slab per partition.
+    parallel_for (
+        s::count,
+        [ & ] ( unsigned const p_, std::size_t const b_, std::size_t const e_ ) noexcept {
+            int * const o = positions.data ( ) + s::size * p_;
+            for ( int i = static_cast<int> ( b_ ); i < static_cast<int> ( e_ ); ++i ) {
+                V const * const v = a_.data ( ) + i * s::size;
+                std::iota ( o, o + s::size, 0 );
+                std::partial_sort ( o, o + K, o + s::size, [ v ] ( int const a_, int const b_ ) noexcept {
+                    return detail::before<O> ( v[ a_ ], v[ b_ ] ) or ( v[ a_ ] == v[ b_ ] and a_ < b_ );
+                } );
+                for ( int j = 0; j < K; ++j ) {
+                    values_.data ( )[ i * K + j ]  = static_cast<T> ( v[ o[ j ] ] );
+                    indices_.data ( )[ i * K + j ] = s::index ( o[ j ] );
+                }
+            }
+        },
+        threads_, 1 );
+}
+
+} // namespace sax
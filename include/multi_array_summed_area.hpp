@@ -0,0 +1,213 @@
+
+// MIT License
+//
+// Copyright (c) 2019, 2020 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cassert> // assert
+#include <cstddef> // std::size_t
+#include <cstdint> // std::int64_t, std::uint64_t
+
+#include <array>
+#include <type_traits>
+#include <vector>
+
+#include "multi_array.hpp"
+#include "multi_array_parallel.hpp"
+
+// Summed-area tables (integral images) of any of Vector, Matrix, Cube or HyperCube. SummedArea<Array> holds, for every
+//  element, the sum of all elements in the box from the origin up to and including it, so the sum (count, mean) over
+//  any box [ lo, hi ] (inclusive, base-adjusted) takes 2^rank lookups, whatever the size of the box.
+//
+//  The table has one extra (zero) slice in front in every dimension, so queries need no bounds special-casing. It is
+//  built by one prefix pass per dimension, all passes but the last add whole contiguous slices [and vectorize], all of
+//  them run in parallel, over the columns or over the slices. update ( ) rebuilds only the part of the table that
+//  depends on a changed block of cells.
+//
+//  Acc, the type of the sums, defaults to std::int64_t [std::uint64_t] for (un)signed integers and double otherwise.
+
+namespace sax {
+
+namespace detail {
+
+template<typename T>
+using summed_area_acc_t = std::conditional_t<std::is_integral_v<T>,
+                                             std::conditional_t<std::is_signed_v<T>, std::int64_t, std::uint64_t>, double>;
+}
+
+template<typename Array, typename Acc = detail::summed_area_acc_t<typename Array::value_type>>
+class SummedArea {
+
+    using layout = detail::layout<Array>;
+
+    public:
+    using value_type       = Acc;
+    using coordinates_type = coordinates_t<Array>;
+
+    static constexpr int rank = layout::rank;
+
+    private:
+    // The strides of the table, every extent is one larger.
+    static constexpr std::array<std::size_t, rank + 1> strides = [] ( ) noexcept {
+        std::array<std::size_t, rank + 1> s{ };
+        s[ rank ] = 1;
+        for ( int r = rank - 1; r >= 0; --r )
+            s[ r ] = s[ r + 1 ] * static_cast<std::size_t> ( layout::extents[ r ] + 1 );
+        return s;
+    }( );
+
+    std::vector<Acc> m_table;
+
+    // The offset in the table of (base-adjusted) c_, shifted by one in every dimension.
+    [[nodiscard]] static std::size_t offset ( coordinates_type const & c_ ) noexcept {
+        std::size_t o = 0;
+        for ( int r = 0; r < rank; ++r )
+            o += static_cast<std::size_t> ( c_[ r ] - layout::bases[ r ] + 1 ) * strides[ r + 1 ];
+        return o;
+    }
+
+    // The running sum along dimension r_, of lines [ b_, e_ ) [over all slices] or of columns [ b_, e_ ) [of slice o_].
+    void prefix ( int const r_, std::size_t const o_, std::size_t const b_, std::size_t const e_ ) noexcept {
+        std::size_t const n = static_cast<std::size_t> ( layout::extents[ r_ ] ) + 1, s = strides[ r_ + 1 ];
+        Acc * const p       = m_table.data ( ) + o_ * strides[ r_ ];
+        for ( std::size_t t = 1; t < n; ++t ) {
+            Acc * const c       = p + t * s;
+            Acc const * const q = c - s;
+            for ( std::size_t j = b_; j < e_; ++j )
+                c[ j ] += q[ j ];
+        }
+    }
+
+    public:
+    SummedArea ( ) : m_table ( strides[ 0 ] ) {}
+    explicit SummedArea ( Array const & a_, unsigned const threads_ = 0 ) : SummedArea ( ) { assign ( a_, threads_ ); }
+
+    // Builds the table of a_.
+    void assign ( Array const & a_, unsigned const threads_ = 0 ) {
+        constexpr std::size_t columns = static_cast<std::size_t> ( layout::extents[ rank - 1 ] ),
+                              rows    = Array::size ( ) / columns;
+        // The elements, into the interior.
+        parallel_for (
+            rows,
+            [ this, &a_ ] ( unsigned, std::size_t const b_, std::size_t const e_ ) noexcept {
+                for ( std::size_t i = b_; i < e_; ++i ) {
+                    std::size_t q = i, o = 1;
+                    for ( int r = rank - 2; r >= 0; --r ) {
+                        std::size_t const e = static_cast<std::size_t> ( layout::extents[ r ] );
+                        o += ( q % e + 1 ) * strides[ r + 1 ];
+                        q /= e;
+                    }
+                    auto const * const s = a_.data ( ) + i * columns;
+                    Acc * const d        = m_table.data ( ) + o;
+                    for ( std::size_t j = 0; j < columns; ++j )
+                        d[ j ] = static_cast<Acc> ( s[ j ] );
+                }
+            },
+            threads_, 64 );
+        // The passes, over the slices, or if there is only one, over its columns.
+        for ( int r = 0; r < rank; ++r ) {
+            std::size_t const slices = strides[ 0 ] / strides[ r ], columns = strides[ r + 1 ];
+            if ( slices > 1 )
+                parallel_for (
+                    slices,
+                    [ this, r ] ( unsigned, std::size_t const b_, std::size_t const e_ ) noexcept {
+                        for ( std::size_t o = b_; o < e_; ++o )
+                            prefix ( r, o, 0, strides[ r + 1 ] );
+                    },
+                    threads_, 1 + 4096 / columns );
+            else
+                parallel_for (
+                    columns,
+                    [ this, r ] ( unsigned, std::size_t const b_, std::size_t const e_ ) noexcept { prefix ( r, 0, b_, e_ ); },
+                    threads_, 4096 );
+        }
+    }
+
+    // Rebuilds the table after (any of) the elements of a_ in the box [ lo_, end ) changed, in 2^rank lookups per element
+    //  of that box, every sum in it depends on the changed elements.
+    void update ( Array const & a_, coordinates_type const & lo_ ) noexcept {
+        coordinates_type c = lo_;
+        for ( ;; ) {
+            std::size_t const o = offset ( c );
+            Acc s               = static_cast<Acc> ( a_.data ( )[ layout::offset ( c ) ] );
+            // S[ x ] = a[ x ] + sum over the non-empty subsets m of the dimensions of -( -1 )^|m| S[ x - e_m ].
+            for ( unsigned m = 1; m < ( 1u << rank ); ++m ) {
+                std::size_t d = 0;
+                int n         = 0;
+                for ( int r = 0; r < rank; ++r )
+                    if ( m >> r & 1u )
+                        d += strides[ r + 1 ], ++n;
+                if ( n & 1 )
+                    s += m_table[ o - d ];
+                else
+                    s -= m_table[ o - d ];
+            }
+            m_table[ o ] = s;
+            int r        = rank - 1; // Next c, row-major.
+            for ( ; r >= 0 and ++c[ r ] == layout::extents[ r ] + layout::bases[ r ]; --r )
+                c[ r ] = lo_[ r ];
+            if ( r < 0 )
+                return;
+        }
+    }
+
+    // The sum of the elements in the box [ lo_, hi_ ], both inclusive, hi_ [in any dimension] may be one below lo_, an
+    //  empty box.
+    [[nodiscard]] Acc sum ( coordinates_type const & lo_, coordinates_type const & hi_ ) const noexcept {
+        Acc s = Acc{ };
+        for ( unsigned m = 0; m < ( 1u << rank ); ++m ) {
+            std::size_t o = 0;
+            int n         = 0; // The lower corners.
+            for ( int r = 0; r < rank; ++r ) {
+                assert ( lo_[ r ] >= layout::bases[ r ] and hi_[ r ] < layout::extents[ r ] + layout::bases[ r ] );
+                assert ( lo_[ r ] <= hi_[ r ] + 1 );
+                if ( m >> r & 1u )
+                    o += static_cast<std::size_t> ( hi_[ r ] - layout::bases[ r ] + 1 ) * strides[ r + 1 ];
+                else
+                    o += static_cast<std::size_t> ( lo_[ r ] - layout::bases[ r ] ) * strides[ r + 1 ], ++n;
+            }
+            if ( n & 1 )
+                s -= m_table[ o ];
+            else
+                s += m_table[ o ];
+        }
+        return s;
+    }
+
+    // The number of elements in the box [ lo_, hi_ ].
+    [[nodiscard]] static constexpr std::size_t count ( coordinates_type const & lo_, coordinates_type const & hi_ ) noexcept {
+        std::size_t n = 1;
+        for ( int r = 0; r < rank; ++r )
+            n *= static_cast<std::size_t> ( hi_[ r ] - lo_[ r ] + 1 );
+        return n;
+    }
+
+    // The mean of the elements in the (non-empty) box [ lo_, hi_ ].
+    [[nodiscard]] double mean ( coordinates_type const & lo_, coordinates_type const & hi_ ) const noexcept {
+        return static_cast<double> ( sum ( lo_, hi_ ) ) / static_cast<double> ( count ( lo_, hi_ ) );
+    }
+
+    // The sum of the elements in the box from the origin up to and including c_.
+    [[nodiscard]] Acc at ( coordinates_type const & c_ ) const noexcept { return m_table[ offset ( c_ ) ]; }
+};
+
+} // namespace sax
@@ -0,0 +1,285 @@
+
+// MIT License
+//
+// Copyright (c) 2019, 2020 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cassert> // assert
+#include <cstddef> // std::size_t, std::byte
+#include <cstdint> // std::uint64_t
+#include <cstring> // std::memcmp, std::memcpy
+
+#include <array>
+#include <bit> // std::countr_zero
+#include <iterator>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#if defined( __AVX2__ )
+#    include <immintrin.h>
+#endif
+
+#include "multi_array.hpp"
+
+// Dirty tracking, for incremental persistence and synchronization of large arrays.
+//
+//  Tracked<Array, Tile> is an Array, divided in tiles of Tile elements [by default one 4 KiB page], that marks the
+//  tiles it hands out a mutable reference [or span] to as dirty, in a bitmap. dirty ( ) iterates the dirty regions,
+//  runs of consecutive dirty tiles, as { offset, size } in elements, so a sync writes [f.e. pwrite's] only those.
+//  clear ( ) starts a new epoch, after a sync. Reads through get ( ) or array ( ) don't mark anything.
+//
+//  Without tracking, diff ( ) compares two arrays tile by tile [with AVX2, 32 bytes at a time, stopping at the first
+//  difference in a tile] into the regions that differ, pack_regions ( ) packs the elements of the regions into a compact
+//  delta and unpack_regions ( ) applies it to a copy.
+
+namespace sax {
+
+// A range of elements [ offset, offset + size ), of the flat data ( ) of an array.
+struct region {
+    std::size_t offset, size;
+};
+
+namespace detail {
+
+// The elements in a 4 KiB page.
+template<typename T>
+inline constexpr std::size_t page_elements_v = sizeof ( T ) <= 4096 ? 4096 / sizeof ( T ) : 1;
+
+// Whether the n_ bytes at a_ and b_ are equal.
+[[nodiscard]] inline bool equal_bytes ( std::byte const * a_, std::byte const * b_, std::size_t n_ ) noexcept {
+#if defined( __AVX2__ )
+    for ( ; n_ >= 64; a_ += 64, b_ += 64, n_ -= 64 ) {
+        __m256i const x = _mm256_xor_si256 ( _mm256_loadu_si256 ( reinterpret_cast<__m256i const *> ( a_ ) ),
+                                             _mm256_loadu_si256 ( reinterpret_cast<__m256i const *> ( b_ ) ) );
+        __m256i const y = _mm256_xor_si256 ( _mm256_loadu_si256 ( reinterpret_cast<__m256i const *> ( a_ + 32 ) ),
+                                             _mm256_loadu_si256 ( reinterpret_cast<__m256i const *> ( b_ + 32 ) ) );
+        __m256i const z = _mm256_or_si256 ( x, y );
+        if ( not _mm256_testz_si256 ( z, z ) )
+            return false;
+    }
+#endif
+    return 0 == std::memcmp ( a_, b_, n_ );
+}
+
+// Appends [ b_, e_ ) to r_, extending the last region if they touch.
+inline void append ( std::vector<region> & r_, std::size_t const b_, std::size_t const e_ ) {
+    if ( not r_.empty ( ) and r_.back ( ).offset + r_.back ( ).size == b_ )
+        r_.back ( ).size += e_ - b_;
+    else
+        r_.push_back ( { b_, e_ - b_ } );
+}
+} // namespace detail
+
+template<typename Array, std::size_t Tile = detail::page_elements_v<typename Array::value_type>>
+class Tracked {
+
+    using layout = detail::layout<Array>;
+
+    public:
+    using value_type       = typename Array::value_type;
+    using reference        = value_type &;
+    using size_type        = std::size_t;
+    using extents_type     = typename Array::extents_type;
+    using coordinates_type = coordinates_t<Array>;
+
+    static constexpr std::size_t tile  = Tile;
+    static constexpr std::size_t tiles = ( Array::size ( ) + Tile - 1 ) / Tile;
+
+    [[nodiscard]] static constexpr std::size_t size ( ) noexcept { return Array::size ( ); }
+    [[nodiscard]] static constexpr extents_type extents ( ) noexcept { return Array::extents ( ); }
+    [[nodiscard]] static constexpr extents_type bases ( ) noexcept { return Array::bases ( ); }
+
+    private:
+    static constexpr std::size_t words = ( tiles + 63 ) / 64;
+
+    Array m_array;
+    std::array<std::uint64_t, words> m_dirty{ };
+    std::uint64_t m_epoch = 0;
+
+    void mark ( std::size_t const t_ ) noexcept { m_dirty[ t_ >> 6 ] |= std::uint64_t{ 1 } << ( t_ & 63 ); }
+
+    public:
+    // The dirty regions, in increasing order, the tiles of a region are dirty, the tiles around it are not.
+    class regions {
+
+        std::array<std::uint64_t, words> const * m_dirty;
+
+        public:
+        class iterator {
+
+            std::array<std::uint64_t, words> const * m_dirty;
+            std::size_t m_begin, m_end; // Tiles, m_begin == tiles at the end.
+
+            // The first tile from t_ on with bit d_ [dirty or clean], tiles if there's none.
+            [[nodiscard]] std::size_t find ( std::size_t const t_, bool const d_ ) const noexcept {
+                if ( t_ >= tiles )
+                    return tiles;
+                std::size_t w     = t_ >> 6;
+                std::uint64_t b   = ( d_ ? ( *m_dirty )[ w ] : ~( *m_dirty )[ w ] ) & ( ~std::uint64_t{ 0 } << ( t_ & 63 ) );
+                while ( not b and ++w < words )
+                    b = d_ ? ( *m_dirty )[ w ] : ~( *m_dirty )[ w ];
+                if ( not b )
+                    return tiles;
+                std::size_t const t = ( w << 6 ) + static_cast<std::size_t> ( std::countr_zero ( b ) );
+                return t < tiles ? t : tiles;
+            }
+
+            void seek ( std::size_t const t_ ) noexcept {
+                m_begin = find ( t_, true );
+                m_end   = find ( m_begin, false );
+            }
+
+            public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type        = region;
+            using difference_type   = std::ptrdiff_t;
+            using pointer           = void;
+            using reference         = region;
+
+            iterator ( ) noexcept = default;
+            iterator ( std::array<std::uint64_t, words> const * d_, std::size_t const t_ ) noexcept : m_dirty{ d_ } { seek ( t_ ); }
+
+            [[nodiscard]] region operator* ( ) const noexcept {
+                std::size_t const e = m_end * Tile < size ( ) ? m_end * Tile : size ( );
+                return { m_begin * Tile, e - m_begin * Tile };
+            }
+            iterator & operator++ ( ) noexcept {
+                seek ( m_end );
+                return *this;
+            }
+            iterator operator++ ( int ) noexcept {
+                iterator i = *this;
+                seek ( m_end );
+                return i;
+            }
+            [[nodiscard]] bool operator== ( iterator const & rhs_ ) const noexcept { return m_begin == rhs_.m_begin; }
+        };
+
+        explicit regions ( std::array<std::uint64_t, words> const * d_ ) noexcept : m_dirty{ d_ } {}
+
+        [[nodiscard]] iterator begin ( ) const noexcept { return iterator{ m_dirty, 0 }; }
+        [[nodiscard]] iterator end ( ) const noexcept { return iterator{ m_dirty, tiles }; }
+    };
+
+    // All tiles start dirty, nothing has been synchronized yet.
+    Tracked ( ) noexcept { mark_all ( ); }
+    explicit Tracked ( Array const & a_ ) noexcept : m_array{ a_ } { mark_all ( ); }
+
+    // Mutable access, marks the tile of the element dirty.
+    template<typename... Indices>
+    [[nodiscard]] reference at ( Indices const... i_ ) noexcept {
+        static_assert ( sizeof...( Indices ) == layout::rank );
+        int const o = layout::offset ( { i_... } );
+        mark ( static_cast<std::size_t> ( o ) / Tile );
+        return m_array.data ( )[ o ];
+    }
+    template<typename... Indices>
+    [[nodiscard]] value_type at ( Indices const... i_ ) const noexcept {
+        return get ( i_... );
+    }
+    // Read access, marks nothing.
+    template<typename... Indices>
+    [[nodiscard]] value_type get ( Indices const... i_ ) const noexcept {
+        static_assert ( sizeof...( Indices ) == layout::rank );
+        return m_array.data ( )[ layout::offset ( { i_... } ) ];
+    }
+
+    // The elements [ offset_, offset_ + size_ ) of the flat data, mutable, marks their tiles dirty.
+    [[nodiscard]] std::span<value_type> span ( std::size_t const offset_, std::size_t const size_ ) noexcept {
+        assert ( offset_ + size_ <= size ( ) );
+        mark ( offset_, size_ );
+        return { m_array.data ( ) + offset_, size_ };
+    }
+
+    // Marks the tiles of the elements [ offset_, offset_ + size_ ) [f.e. after writing through a pointer] dirty.
+    void mark ( std::size_t const offset_, std::size_t const size_ ) noexcept {
+        if ( size_ )
+            for ( std::size_t t = offset_ / Tile, e = ( offset_ + size_ - 1 ) / Tile; t <= e; ++t )
+                mark ( t );
+    }
+    void mark_all ( ) noexcept {
+        m_dirty.fill ( ~std::uint64_t{ 0 } );
+        if constexpr ( tiles & 63 )
+            m_dirty.back ( ) = ( std::uint64_t{ 1 } << ( tiles & 63 ) ) - 1;
+    }
+
+    [[nodiscard]] bool dirty ( std::size_t const tile_ ) const noexcept { return m_dirty[ tile_ >> 6 ] >> ( tile_ & 63 ) & 1u; }
+    [[nodiscard]] std::size_t dirty_tiles ( ) const noexcept {
+        std::size_t n = 0;
+        for ( std::uint64_t const w : m_dirty )
+            n += static_cast<std::size_t> ( std::popcount ( w ) );
+        return n;
+    }
+    [[nodiscard]] regions dirty ( ) const noexcept { return regions{ &m_dirty }; }
+
+    // Marks all tiles clean and starts a new epoch, returns the epoch that ended.
+    std::uint64_t clear ( ) noexcept {
+        m_dirty.fill ( 0 );
+        return m_epoch++;
+    }
+    [[nodiscard]] std::uint64_t epoch ( ) const noexcept { return m_epoch; }
+
+    [[nodiscard]] Array const & array ( ) const noexcept { return m_array; }
+    [[nodiscard]] value_type const * data ( ) const noexcept { return m_array.data ( ); }
+};
+
+// Appends to r_ the regions [of whole tiles of Tile elements, coalesced] in which a_ and b_ differ, returns the number
+//  of tiles that differ.
+template<std::size_t Tile, typename Array>
+std::size_t diff ( Array const & a_, Array const & b_, std::vector<region> & r_ ) {
+    using T = typename Array::value_type;
+    static_assert ( std::is_trivially_copyable_v<T> );
+    constexpr std::size_t size = Array::size ( );
+    auto const * const a       = reinterpret_cast<std::byte const *> ( a_.data ( ) );
+    auto const * const b       = reinterpret_cast<std::byte const *> ( b_.data ( ) );
+    std::size_t n              = 0;
+    for ( std::size_t t = 0; t < size; t += Tile ) {
+        std::size_t const e = t + Tile < size ? t + Tile : size;
+        if ( detail::equal_bytes ( a + t * sizeof ( T ), b + t * sizeof ( T ), ( e - t ) * sizeof ( T ) ) )
+            continue;
+        detail::append ( r_, t, e );
+        ++n;
+    }
+    return n;
+}
+
+// The elements of a_ in the regions r_, one after the other, appended to d_.
+template<typename Array, typename Regions>
+void pack_regions ( Array const & a_, Regions const & r_, std::vector<typename Array::value_type> & d_ ) {
+    for ( region const r : r_ ) {
+        assert ( r.offset + r.size <= Array::size ( ) );
+        d_.insert ( d_.end ( ), a_.data ( ) + r.offset, a_.data ( ) + r.offset + r.size );
+    }
+}
+
+// Copies the elements d_, as packed from the regions r_, back into the regions r_ of a_.
+template<typename Array, typename Regions>
+void unpack_regions ( Array & a_, Regions const & r_, std::span<typename Array::value_type const> d_ ) noexcept {
+    for ( region const r : r_ ) {
+        assert ( r.offset + r.size <= Array::size ( ) and r.size <= d_.size ( ) );
+        std::memcpy ( a_.data ( ) + r.offset, d_.data ( ), r.size * sizeof ( typename Array::value_type ) );
+        d_ = d_.subspan ( r.size );
+    }
+}
+
+} // namespace sax